@@ -12,31 +12,35 @@ namespace tree_search {
         template <typename Node>
         void fixup(std::unique_ptr<Node>& t, capability_remove) { } // for the cases when a tree has some invariants to restore
 
+        // Detaches the leftmost node of a non-empty tree restoring the invariants on the way up. The node keeps its value untouched.
+        template <typename Node, typename Tag>
+        std::unique_ptr<Node> detach_min(std::unique_ptr<Node>& tree, Tag tag) {
+            if (tree->left_) {
+                auto min = detach_min(tree->left_, tag);
+                fixup(tree, tag);
+                return min;
+            }
+            auto min = std::move(tree);
+            tree = std::move(min->right_);
+            return min;
+        }
+
         template <typename T, typename Node, typename Tag>
         void remove(std::unique_ptr<Node>& tree, const T& v, Tag tag) {
             if (!tree) return;
             else if (v < tree->value_) remove(tree->left_, v, tag);
             else if (v > tree->value_) remove(tree->right_, v, tag);
-            else { // found
+            else { // found. nodes are relinked rather than values moved, so the remaining elements keep their addresses
                 if (tree->left_ && tree->right_) {
-                    auto ptr = tree->right_.get();
-                    while (ptr->left_) ptr = ptr->left_.get();
-                    std::swap(tree->value_, ptr->value_);
-                    remove(tree->right_, v, tag); // going down is not necessary for BSTs, but might be for AVLs or RB-trees
-                                                  // it's still log_2(n) deep, though: 
-                                                  // in a tree with 10^15 (quadrillion) nodes there would be at most 50 recursive calls. 
-                }
-                else if (tree->left_) {
-                    std::swap(tree->value_, tree->left_->value_);
-                    remove(tree->left_, v, tag);
-                }
-                else if (tree->right_) {
-                    std::swap(tree->value_, tree->right_->value_);
-                    remove(tree->right_, v, tag);
+                    auto succ = detach_min(tree->right_, tag); // the successor takes the place of the removed node
+                    succ->left_ = std::move(tree->left_);
+                    succ->right_ = std::move(tree->right_);
+                    tree = std::move(succ);
                 }
-                else {
-                    tree = nullptr;
-                    return;
+                else { // the only child (if any) takes the place of the removed node
+                    auto child = std::move(tree->left_ ? tree->left_ : tree->right_);
+                    tree = std::move(child);
+                    return; // the child's subtree has not changed
                 }
             }
             fixup(tree, tag);
@@ -10,6 +10,13 @@ namespace tree_search {
     struct rotate_left_tag {};
     struct rotate_right_tag {};
 
+    namespace aux {
+        // Called for the node a rotation has moved down and then for the one moved up. Augments keeping subtree aggregates
+        // overload it, so a rotation restores them on the spot and balancing code recomputes nothing but the path it walks.
+        template <typename T>
+        inline void rotated(T&) {}
+    }
+
     // versions for a node-like tree
     template <typename Node>
     void rotate(std::unique_ptr<Node>& cur, rotate_right_tag) {
@@ -18,6 +25,9 @@ namespace tree_search {
         cur->left_ = std::move(left->right_); // left->rights's parent points on self because it was bound previously to cur->left
         left->right_ = std::move(cur);
         cur = std::move(left);
+        using aux::rotated; // augments provide their own versions found by ADL
+        rotated(cur->right_);
+        rotated(cur);
     }
     template <typename Node>
     void rotate(std::unique_ptr<Node>& cur, rotate_left_tag) {
@@ -26,6 +36,9 @@ namespace tree_search {
         cur->right_ = std::move(right->left_);
         right->left_ = std::move(cur);
         cur = std::move(right);
+        using aux::rotated;
+        rotated(cur->left_);
+        rotated(cur);
     }
 
     // version for the outermost tree container
@@ -4,7 +4,10 @@
 #include "iterator.hpp"
 #include "tree_interval.hpp"
 
+#include <cstddef> // size_t
+#include <memory> // std::unique_ptr
 #include <type_traits>
+#include <utility> // std::pair
 
 namespace tree_search {
 
@@ -14,35 +17,131 @@ namespace tree_search {
         struct spec_right {};
         struct spec_cur {};
 
-        //how iterator would detect intersections
+        //how iterator would detect intersections. A query might be of any type with interval_traits; it is read under the rules of the tree's intervals.
         template <typename Tree, typename SpecTag>
         struct interval_intersect {
+            using interval_type = aux::value_type_t<Tree>;
+            using bound_type = typename interval_traits<interval_type>::bound_type;
 
             interval_intersect() = default;
-            explicit interval_intersect(const aux::value_type_t<Tree>& bounds) : bounds_(bounds) {}
+            template <typename Interval>
+            explicit interval_intersect(const Interval& bounds) : bounds_(start_of(bounds), end_of(bounds)) {}
 
             template <typename U = SpecTag, std::enable_if_t<std::is_same_v<U, spec_left>, int> = 0>
             inline bool operator()(const aux::node_type_t<Tree>* p) const { // left child's max border MIGHT get smaller with each next step down the tree 
-                return p->left_ && p->left_->max_ >= this->bounds_.first;
+                return p->left_ && !ends_before<interval_type>(p->left_->max_, this->bounds_.first);
             }
 
             template <typename U = SpecTag, std::enable_if_t<std::is_same_v<U, spec_right>, int> = 0>
-            inline bool operator()(const aux::node_type_t<Tree>* p) const { // right child's left border gets ever bigger with each next step down the tree 
-                return p->right_ && p->right_->value_.first <= this->bounds_.second;
+            inline bool operator()(const aux::node_type_t<Tree>* p) const { // left borders within the right subtree are not less than the current one
+                return p->right_
+                    && !starts_after<interval_type>(start_of(p->value_), this->bounds_.second)
+                    && !ends_before<interval_type>(p->right_->max_, this->bounds_.first);
             }
 
             template <typename U = SpecTag, std::enable_if_t<std::is_same_v<U, spec_cur>, int> = 0>
             inline bool operator()(const aux::node_type_t<Tree>* p) const { // covers all 3 possible cases of intersection with the current node
-                return this->bounds_.first <= p->value_.second && this->bounds_.second >= p->value_.first;
+                return !starts_after<interval_type>(start_of(p->value_), this->bounds_.second)
+                    && !ends_before<interval_type>(end_of(p->value_), this->bounds_.first);
             }
-            aux::value_type_t<Tree> bounds_ = {};
+            std::pair<bound_type, bound_type> bounds_ = {};
         };
 
+        // how iterator would detect a point within intervals. Half as many comparisons as the interval version needs.
+        template <typename Tree, typename SpecTag>
+        struct point_intersect {
+            using interval_type = aux::value_type_t<Tree>;
+            using point_type = typename interval_traits<interval_type>::bound_type;
+
+            point_intersect() = default;
+            explicit point_intersect(const point_type& point) : point_(point) {}
+
+            template <typename U = SpecTag, std::enable_if_t<std::is_same_v<U, spec_left>, int> = 0>
+            inline bool operator()(const aux::node_type_t<Tree>* p) const {
+                return p->left_ && !ends_before<interval_type>(p->left_->max_, this->point_);
+            }
+
+            template <typename U = SpecTag, std::enable_if_t<std::is_same_v<U, spec_right>, int> = 0>
+            inline bool operator()(const aux::node_type_t<Tree>* p) const { // left borders within the right subtree are not less than the current one
+                return p->right_ && !(this->point_ < start_of(p->value_)) && !ends_before<interval_type>(p->right_->max_, this->point_);
+            }
+
+            template <typename U = SpecTag, std::enable_if_t<std::is_same_v<U, spec_cur>, int> = 0>
+            inline bool operator()(const aux::node_type_t<Tree>* p) const {
+                return !(this->point_ < start_of(p->value_)) && !ends_before<interval_type>(end_of(p->value_), this->point_);
+            }
+            point_type point_ = {};
+        };
+
+        // Visits intervals containing the point in order until the visitor returns false. Returns false if stopped.
+        // A point belongs to an interval if it is not before the start and the interval does not end before it (see ends_before).
+        template <typename Node, typename T, typename F>
+        bool stab(const std::unique_ptr<Node>& tree, const T& point, F& f) {
+            using interval_type = typename Node::value_type;
+            if (!tree || ends_before<interval_type>(tree->max_, point)) return true;
+            if (!stab(tree->left_, point, f)) return false;
+            if (point < start_of(tree->value_)) return true; // the rest starts later still
+            if (!ends_before<interval_type>(end_of(tree->value_), point) && !f(tree->value_)) return false;
+            return stab(tree->right_, point, f);
+        }
+
+        // The first interval in order containing the point, or nullptr. One path down the tree:
+        // if the left subtree ends at or after the point, either it holds an answer or nothing to the right of it does.
+        template <typename Node, typename T>
+        const Node* stab_first(const std::unique_ptr<Node>& tree, const T& point) {
+            using interval_type = typename Node::value_type;
+            auto p = tree.get();
+            while (p && !ends_before<interval_type>(p->max_, point)) {
+                if (p->left_ && !ends_before<interval_type>(p->left_->max_, point)) p = p->left_.get();
+                else if (point < start_of(p->value_)) return nullptr;
+                else if (!ends_before<interval_type>(end_of(p->value_), point)) return p;
+                else p = p->right_.get();
+            }
+            return nullptr;
+        }
+
+        // Number of intervals not starting after a bound in O(log n). 'after' tells if a start lies after the bound.
+        template <typename Node, typename F>
+        size_t count_starting_up_to(const std::unique_ptr<Node>& tree, F after) {
+            size_t n = 0;
+            for (auto p = tree.get(); p; ) {
+                if (after(start_of(p->value_))) p = p->left_.get();
+                else {
+                    n += 1 + (p->left_ ? p->left_->count_ : 0);
+                    p = p->right_.get();
+                }
+            }
+            return n;
+        }
+
+        // Number of intervals ending before a in O(log n), from the index of ends: those ending before a come first there
+        template <typename Tree, typename T>
+        size_t count_ending_before(const Tree& tree, const T& a) {
+            using interval_type = value_type_t<Tree>;
+            return count_starting_up_to(access(tree.ends_), [&](auto&& e) { return !ends_before<interval_type>(e, a); });
+        }
+
+        // Enables int type for counting and point queries on interval trees
+        template <typename Tree>
+        using enable_interval_query_t =
+            std::enable_if_t<std::is_base_of_v<capability_search_interval, Tree>
+                && has_interval_aggregates<Tree>::value // interval_augment or any other augment keeping the aggregates
+            , int>;
+
+        // Enables int type for counting on interval trees keeping an index of ends (capability_count_interval)
+        template <typename Tree>
+        using enable_interval_count_t =
+            std::enable_if_t<std::is_base_of_v<capability_search_interval, Tree>
+                && has_interval_aggregates<Tree>::value
+                && is_counted<Tree>::value
+            , int>;
+
         // Enables int type if interval tree requirements are satisfied
         template <typename Tag, typename Interval, typename Tree>
         using enable_interval_search_t =
             std::enable_if_t<std::is_base_of_v<capability_search_interval, Tree>
-                && std::is_same_v<augment_type_t<Tree>, interval_augment<Interval, node_type_t<Tree>>> // only for trees with interval_augment type within
+                && has_interval_aggregates<Tree>::value // only for trees with interval aggregates within
+                && std::is_same_v<typename interval_traits<Interval>::bound_type, typename interval_traits<value_type_t<Tree>>::bound_type> // queries might be of another interval type
             , int>;
     }
 
@@ -56,4 +155,53 @@ namespace tree_search {
 
         return iterators<iterator_type>{ iterator_type(aux::access(tree).get(), interval), iterator_type() };
     }
+
+    // Counts intervals overlapping the given one in O(log n). Every interval starting not later than the end of the query
+    // overlaps it unless it ends before the query starts. The first part is counted from subtree aggregates,
+    // the second one from the index of ends, so the tree needs capability_count_interval.
+    template <typename Interval, typename Tree, aux::enable_interval_count_t<Tree> = 0>
+    size_t count_overlaps(const Tree& tree, const Interval& interval) {
+        using interval_type = aux::value_type_t<Tree>;
+        using bound_type = typename interval_traits<interval_type>::bound_type;
+        bound_type a = aux::start_of(interval);
+        bound_type b = aux::end_of(interval);
+        if (aux::empty_interval<interval_type>(a, b)) return 0;
+        auto&& root = aux::access(tree);
+        return aux::count_starting_up_to(root, [&](auto&& s) { return aux::starts_after<interval_type>(s, b); })
+             - aux::count_ending_before(tree, a);
+    }
+
+    // Counts intervals containing the point. Same cost as count_overlaps
+    template <typename T, typename Tree, aux::enable_interval_count_t<Tree> = 0>
+    size_t count_stabbing(const Tree& tree, const T& point) {
+        typename interval_traits<aux::value_type_t<Tree>>::bound_type p = point;
+        return aux::count_starting_up_to(aux::access(tree), [&](auto&& s) { return p < s; }) - aux::count_ending_before(tree, p);
+    }
+
+    // Intervals containing the point. Same as searching for a closed {point, point}, with point-specific predicates.
+    template <typename Tag, typename T, typename Tree, aux::enable_interval_query_t<Tree> = 0>
+    auto stab(Tag&& tag, const Tree& tree, const T& point) {
+
+        using left = aux::point_intersect<Tree, aux::spec_left>;
+        using right = aux::point_intersect<Tree, aux::spec_right>;
+        using cur = aux::point_intersect<Tree, aux::spec_cur>;
+        using iterator_type = tree_search::iterator<Tree, Tag, cur, left, right>;
+
+        return iterators<iterator_type>{ iterator_type(aux::access(tree).get(), typename cur::point_type(point)), iterator_type() };
+    }
+
+    // Visitor form: f(interval) is called in order for intervals containing the point until it returns false
+    template <typename T, typename Tree, typename F, aux::enable_interval_query_t<Tree> = 0>
+    void stab(const Tree& tree, const T& point, F&& f) {
+        using point_type = typename interval_traits<aux::value_type_t<Tree>>::bound_type;
+        aux::stab(aux::access(tree), point_type(point), f);
+    }
+
+    // The first interval in order containing the point in O(log n), or nullptr
+    template <typename T, typename Tree, aux::enable_interval_query_t<Tree> = 0>
+    const aux::value_type_t<Tree>* stab_first(const Tree& tree, const T& point) {
+        using point_type = typename interval_traits<aux::value_type_t<Tree>>::bound_type;
+        auto p = aux::stab_first(aux::access(tree), point_type(point));
+        return p ? &p->value_ : nullptr;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "iterator_aux.hpp"
+#include "tree.hpp"
+
+#include <iterator> // std::iterator_traits
+#include <memory> // std::shared_ptr
+#include <mutex> // std::unique_lock
+#include <shared_mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility> // std::forward, std::move, std::as_const, std::swap
+
+namespace tree_search {
+
+    // Makes a tree shareable between threads: reads take the lock shared, writes take it exclusively.
+    // Unlike the other capabilities it carries state, so a tree with it is neither copyable nor movable.
+    // Such a tree is used within read() and write() only, or through the iterators of traverse_shared and search_shared;
+    // insert, traverse, size and the like do not compile on it outside.
+    // The lock is not reentrant: a thread holding read access must not start a write on the same tree.
+    //     using tree = tree_search::tree<int, tree_search::redblack_augment, tree_search::capability_insert_redblack, ..., tree_search::capability_shared>;
+    struct capability_shared {
+        mutable std::shared_mutex mutex_;
+    };
+
+    // Iterator which holds read access to its tree for as long as it or any copy of it lives
+    template <typename It>
+    struct shared_iterator {
+
+        using iterator_category = typename std::iterator_traits<It>::iterator_category;
+        using value_type = typename std::iterator_traits<It>::value_type;
+        using difference_type = typename std::iterator_traits<It>::difference_type;
+        using pointer = typename std::iterator_traits<It>::pointer;
+        using reference = typename std::iterator_traits<It>::reference;
+
+        shared_iterator() = default;
+        shared_iterator(It it, std::shared_ptr<std::shared_lock<std::shared_mutex>> lock) : it_(std::move(it)), lock_(std::move(lock)) {}
+
+        shared_iterator& operator++() {
+            ++this->it_;
+            return *this;
+        }
+        bool operator==(const shared_iterator& other) const {
+            return this->it_ == other.it_;
+        }
+        reference operator*() const {
+            return *this->it_;
+        }
+    private:
+        It                                                   it_ = {};
+        std::shared_ptr<std::shared_lock<std::shared_mutex>> lock_; // the end iterator goes without
+    };
+
+    template <typename It>
+    using shared_iterators = iterators<shared_iterator<It>>;
+
+    namespace aux {
+
+        // Enables int type if a tree can be shared between threads
+        template <typename Tree>
+        using enable_shared_t = std::enable_if_t<std::is_base_of_v<capability_shared, Tree>, int>;
+
+        template <typename Tree, typename Capabilities>
+        struct unshared;
+
+        template <typename Element, template <typename, typename> typename Augment, typename ... Shared, typename ... Capabilities>
+        struct unshared<tree<Element, Augment, Shared...>, std::tuple<Capabilities...>> {
+            using type = tree<Element, Augment, Capabilities...>;
+        };
+
+        template <typename Element, template <typename, typename> typename Augment, typename ... Capabilities>
+        auto unshared_capabilities(const tree<Element, Augment, Capabilities...>&)
+            -> decltype(std::tuple_cat(std::declval<std::conditional_t<std::is_same_v<Capabilities, capability_shared>, std::tuple<>, std::tuple<Capabilities>>>()...));
+
+        template <typename Range>
+        auto shared_range(Range&& r, std::shared_lock<std::shared_mutex>&& lock) {
+            using iterator_type = shared_iterator<decltype(r.begin_)>;
+            return shared_iterators<decltype(r.begin_)>{ iterator_type(std::move(r.begin_), std::make_shared<std::shared_lock<std::shared_mutex>>(std::move(lock))),
+                                                         iterator_type(std::move(r.end_), nullptr) };
+        }
+    }
+
+    // The same tree without capability_shared. That is what read and write sections get.
+    template <typename Tree>
+    using unshared_t = typename aux::unshared<Tree, decltype(aux::unshared_capabilities(std::declval<const Tree&>()))>::type;
+
+    namespace aux {
+
+        // Lends the nodes of a shared tree to an unshared_t while read access is held. Every reader has a view of its own
+        // and none of them frees the nodes.
+        template <typename Tree>
+        struct shared_view {
+            explicit shared_view(const Tree& tree) {
+                access(this->tree_).reset(access<const Tree&, true>(tree).get());
+                if constexpr (is_counted<Tree>::value) access(this->tree_.ends_).reset(access(tree.ends_).get());
+            }
+            shared_view(const shared_view&) = delete;
+            shared_view& operator=(const shared_view&) = delete;
+            ~shared_view() {
+                access(this->tree_).release();
+                if constexpr (is_counted<Tree>::value) access(this->tree_.ends_).release();
+            }
+
+            unshared_t<Tree> tree_;
+        };
+    }
+
+    // Runs f(tree) with read access; any number of readers run at once.
+    // f gets the tree as const unshared_t<Tree>&, so every function reading a tree works on it. Nothing obtained from it must leave f.
+    //     auto n = read(bin, [](const auto& b) { return size(b); });
+    template <typename Tree, typename F, aux::enable_shared_t<Tree> = 0>
+    decltype(auto) read(const Tree& tree, F&& f) {
+        std::shared_lock<std::shared_mutex> lock(tree.mutex_);
+        aux::shared_view<Tree> view(tree);
+        return std::forward<F>(f)(std::as_const(view.tree_));
+    }
+
+    // Runs f(tree) with exclusive access. Everything f does is one batch: readers see either none or all of it.
+    // f gets the tree as unshared_t<Tree>, its nodes moved in for the time of the call, so every function changing a tree works on it.
+    //     write(bin, [](auto& b) { insert(b, 1); insert(b, 2); });
+    template <typename Tree, typename F, aux::enable_shared_t<Tree> = 0>
+    decltype(auto) write(Tree& tree, F&& f) {
+        std::unique_lock<std::shared_mutex> lock(tree.mutex_);
+        auto&& root = aux::access<Tree&, true>(tree); // the only place a shared tree is changed
+        struct section {
+            unshared_t<Tree>         tree_;
+            Tree&                    shared_;
+            typename Tree::ptr_type& root_;
+            void swap() {
+                std::swap(aux::access(this->tree_), this->root_);
+                if constexpr (aux::is_counted<Tree>::value) std::swap(this->tree_.ends_, this->shared_.ends_);
+            }
+            ~section() { this->swap(); } // the nodes go back even if f throws
+        } s{ {}, tree, root };
+        s.swap();
+        return std::forward<F>(f)(s.tree_);
+    }
+
+    // Same as search, with read access held by the iterators returned
+    template <typename Tag, typename Tree, typename ... Args, aux::enable_shared_t<Tree> = 0>
+    auto search_shared(Tag&& tag, const Tree& tree, Args&&... args) {
+        std::shared_lock<std::shared_mutex> lock(tree.mutex_);
+        aux::shared_view<Tree> view(tree); // the iterators point to nodes, not to the tree, so they outlive the view
+        return aux::shared_range(search(std::forward<Tag>(tag), std::as_const(view.tree_), std::forward<Args>(args)...), std::move(lock));
+    }
+
+    // Same as traverse, with read access held by the iterators returned
+    template <typename Tag, typename Tree, aux::enable_shared_t<Tree> = 0>
+    auto traverse_shared(Tag&& tag, const Tree& tree) {
+        std::shared_lock<std::shared_mutex> lock(tree.mutex_);
+        aux::shared_view<Tree> view(tree);
+        return aux::shared_range(traverse(std::forward<Tag>(tag), std::as_const(view.tree_)), std::move(lock));
+    }
+}
\ No newline at end of file
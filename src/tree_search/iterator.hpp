@@ -44,7 +44,7 @@ namespace tree_search {
         template <typename ... U>
         iterator(const node_type* root, const U&... u)
             : intersect_(u...), intersect_left_(u...), intersect_right_(u...) {
-            this->stack_.emplace(cont{ root });
+            if (root) this->stack_.emplace(cont{ root }); // an empty tree yields the end iterator right away
             this->step();
         }
         iterator& operator++() {
@@ -0,0 +1,380 @@
+/* Additional material
+- Herlihy, Shavit. The Art of Multiprocessor Programming, ch. 14.4 A Lock-Free Concurrent Skiplist
+- Fraser. Practical lock-freedom https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf
+*/
+#pragma once
+
+#include "iterator_aux.hpp"
+#include "type_traverse.hpp"
+#include "type_cti.hpp"
+
+#include <atomic>
+#include <cstddef> // size_t
+#include <cstdint> // uintptr_t, uint32_t, uint64_t
+#include <functional> // std::function, std::hash
+#include <iterator> // std::forward_iterator_tag
+#include <memory> // std::unique_ptr, std::shared_ptr
+#include <thread> // std::this_thread
+#include <type_traits>
+#include <utility> // std::forward
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Node of a lock-free skiplist. The lowest bit of a link marks the node it leaves from as removed at that level,
+        // so a removal and an insert right after the node cannot both succeed.
+        template <typename T>
+        struct skiplist_node {
+            using value_type = T;
+            using link_type = std::atomic<uintptr_t>;
+
+            template <typename V>
+            skiplist_node(V&& v, int levels) : value_(std::forward<V>(v)), levels_(levels), next_(new link_type[levels]) {
+                for (int i = 0; i != levels; ++i) this->next_[i].store(0, std::memory_order_relaxed);
+            }
+            skiplist_node(int levels) : levels_(levels), next_(new link_type[levels]) { // the head
+                for (int i = 0; i != levels; ++i) this->next_[i].store(0, std::memory_order_relaxed);
+            }
+
+            value_type                   value_ = {};
+            int                          levels_;
+            std::unique_ptr<link_type[]> next_;
+            std::atomic<int>             owners_{ 2 };       // its insert and its membership. the last one to let go retires it
+            skiplist_node*               retired_ = nullptr; // next in the list of removed nodes
+            uint64_t                     retired_epoch_ = 0;
+        };
+
+        template <typename T>
+        skiplist_node<T>* unmarked(uintptr_t link) { return reinterpret_cast<skiplist_node<T>*>(link & ~uintptr_t(1)); }
+
+        inline bool marked(uintptr_t link) { return (link & 1) != 0; }
+
+        template <typename T>
+        uintptr_t link_to(skiplist_node<T>* node) { return reinterpret_cast<uintptr_t>(node); }
+
+        struct alignas(64) epoch_slot { // on a cache line of its own
+            std::atomic<uint64_t> epoch_{ 0 }; // epoch its holder entered at, 0 if it is not held
+            std::atomic<bool>     taken_{ false };
+        };
+
+        // Holds the epoch a skiplist is in for as long as it lives: nodes removed since are not freed meanwhile.
+        // Every operation takes one, and so does a traversal for as long as any of its iterators lives.
+        struct epoch_guard {
+            template <typename Set>
+            explicit epoch_guard(const Set& set) {
+                thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id()); // the slot this thread got the last time
+                for (auto i = hint; ; ++i) {
+                    auto&& s = set.slots_[i % set.slot_count_];
+                    auto free = false;
+                    if (!s.taken_.load(std::memory_order_relaxed) && s.taken_.compare_exchange_strong(free, true)) {
+                        hint = i;
+                        this->slot_ = &s;
+                        break;
+                    }
+                    if ((i + 1 - hint) % set.slot_count_ == 0) std::this_thread::yield(); // every slot is taken: wait for one
+                }
+                this->slot_->epoch_.store(set.epoch_.load());
+                std::atomic_thread_fence(std::memory_order_seq_cst); // the epoch is visible to reclaim before any link is read
+            }
+            epoch_guard(const epoch_guard&) = delete;
+            epoch_guard& operator=(const epoch_guard&) = delete;
+            ~epoch_guard() {
+                this->slot_->epoch_.store(0, std::memory_order_release);
+                this->slot_->taken_.store(false, std::memory_order_release);
+            }
+
+            epoch_slot* slot_ = nullptr;
+        };
+    }
+
+    // Lock-free ordered set for write-heavy concurrent use: insert, remove and contains never block each other.
+    // Traversal is weakly consistent: it sees every element present throughout it and none removed before it started.
+    // Removed nodes are freed by epoch-based reclamation once no operation or traversal that might still reach them is running;
+    // a traversal kept alive holds back freeing of everything removed meanwhile.
+    // Operations and live traversals take one of slot_count_ slots each, and wait while none is free.
+    // Elements must be default constructible, and comparable by < and ==.
+    template <typename T, int Levels = 24>
+    struct lockfree_skiplist {
+        using value_type = T;
+        using node_type = aux::skiplist_node<T>;
+
+        explicit lockfree_skiplist(size_t slots = 128) : head_(new node_type(Levels)), slots_(new aux::epoch_slot[slots]), slot_count_(slots) {}
+        lockfree_skiplist(const lockfree_skiplist&) = delete;
+        lockfree_skiplist& operator=(const lockfree_skiplist&) = delete;
+        ~lockfree_skiplist() {
+            for (auto p = aux::unmarked<T>(this->head_->next_[0].load()); p; ) { // reachable ones
+                auto next = aux::unmarked<T>(p->next_[0].load());
+                if (!aux::marked(p->next_[0].load())) delete p;
+                p = next;
+            }
+            for (auto p = this->retired_.load(); p; ) {
+                auto next = p->retired_;
+                delete p;
+                p = next;
+            }
+            delete this->head_;
+        }
+
+        static constexpr int levels = Levels;
+        static constexpr size_t reclaim_every = 64; // removals between attempts to free
+
+        node_type*                         head_;
+        std::unique_ptr<aux::epoch_slot[]> slots_;
+        size_t                             slot_count_;
+        std::atomic<uint64_t>              epoch_{ 1 };
+        std::atomic<node_type*>            retired_{ nullptr }; // removed and unlinked, not freed yet
+        std::atomic<size_t>                pending_{ 0 };       // nodes in retired_
+        std::atomic<size_t>                retires_{ 0 };
+        std::atomic<bool>                  reclaiming_{ false };
+    };
+
+    namespace aux {
+
+        template <typename Set>
+        struct is_skiplist : std::false_type {};
+
+        template <typename T, int Levels>
+        struct is_skiplist<lockfree_skiplist<T, Levels>> : std::true_type {};
+
+        template <typename Set>
+        using enable_skiplist_t = std::enable_if_t<is_skiplist<std::decay_t<Set>>::value, int>;
+
+        // A level for a new node: each one up with probability 1/2
+        template <int Levels>
+        int random_level() {
+            thread_local uint32_t state = 2463534242u ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&state));
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            int level = 1;
+            for (auto bits = state; (bits & 1) && level < Levels; bits >>= 1) ++level;
+            return level;
+        }
+
+        // Finds predecessors and successors of v at every level, unlinking removed nodes on the way.
+        // Returns true if v is present.
+        template <typename Set, typename V>
+        bool find(Set& set, const V& v, typename Set::node_type** preds, typename Set::node_type** succs) {
+            using value_type = typename Set::value_type;
+        retry:
+            auto pred = set.head_;
+            typename Set::node_type* curr = nullptr;
+            for (int level = Set::levels - 1; level >= 0; --level) {
+                curr = unmarked<value_type>(pred->next_[level].load());
+                while (curr) {
+                    auto succ = curr->next_[level].load();
+                    while (marked(succ)) { // curr is removed: unlink it from pred
+                        auto expected = link_to(curr);
+                        if (!pred->next_[level].compare_exchange_strong(expected, succ & ~uintptr_t(1))) goto retry;
+                        curr = unmarked<value_type>(succ);
+                        if (!curr) break;
+                        succ = curr->next_[level].load();
+                    }
+                    if (!curr || !(curr->value_ < v)) break;
+                    pred = curr;
+                    curr = unmarked<value_type>(succ);
+                }
+                preds[level] = pred;
+                succs[level] = curr;
+            }
+            return curr && curr->value_ == v;
+        }
+
+        // Frees removed nodes no guard might still reach: those retired before the earliest epoch a guard holds.
+        // One thread at a time; the others go on rather than wait for it.
+        template <typename Set>
+        void reclaim(Set& set) {
+            using node_type = typename Set::node_type;
+            if (set.reclaiming_.exchange(true, std::memory_order_acquire)) return;
+            auto oldest = set.epoch_.fetch_add(1) + 1; // nodes retired from now on are kept
+            for (size_t i = 0; i != set.slot_count_; ++i) {
+                auto e = set.slots_[i].epoch_.load();
+                if (e != 0 && e < oldest) oldest = e;
+            }
+            node_type* kept = nullptr;
+            node_type* kept_tail = nullptr;
+            size_t freed = 0;
+            for (auto p = set.retired_.exchange(nullptr); p; ) {
+                auto next = p->retired_;
+                if (p->retired_epoch_ < oldest) {
+                    delete p;
+                    ++freed;
+                }
+                else {
+                    if (!kept) kept_tail = p;
+                    p->retired_ = kept;
+                    kept = p;
+                }
+                p = next;
+            }
+            if (kept) { // back in front of whatever has been retired meanwhile
+                auto head = set.retired_.load();
+                do kept_tail->retired_ = head;
+                while (!set.retired_.compare_exchange_weak(head, kept));
+            }
+            set.pending_ -= freed;
+            set.reclaiming_.store(false, std::memory_order_release);
+        }
+
+        // Lets go of a node for its insert or for its membership. The last one to do so unlinks it from levels an insert
+        // might have linked it at after it was marked, and retires it: nothing leads to it any more.
+        template <typename Set>
+        void release(Set& set, typename Set::node_type* node) {
+            using node_type = typename Set::node_type;
+            if (node->owners_.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            node_type* preds[Set::levels];
+            node_type* succs[Set::levels];
+            find(set, node->value_, preds, succs);
+            node->retired_epoch_ = set.epoch_.load();
+            auto head = set.retired_.load();
+            do node->retired_ = head;
+            while (!set.retired_.compare_exchange_weak(head, node));
+            ++set.pending_;
+            if (set.retires_.fetch_add(1) % Set::reclaim_every == Set::reclaim_every - 1) reclaim(set);
+        }
+    }
+
+    // Returns false if v has been present
+    template <typename V, typename Set, aux::enable_skiplist_t<Set> = 0>
+    bool insert(Set& set, V&& v) {
+        using node_type = typename Set::node_type;
+        node_type* preds[Set::levels];
+        node_type* succs[Set::levels];
+        aux::epoch_guard guard(set);
+        auto top = aux::random_level<Set::levels>();
+        std::unique_ptr<node_type> node(new node_type(std::forward<V>(v), top));
+        while (true) {
+            if (aux::find(set, node->value_, preds, succs)) return false;
+            for (int level = 0; level != top; ++level) node->next_[level].store(aux::link_to(succs[level]), std::memory_order_relaxed);
+            auto expected = aux::link_to(succs[0]);
+            if (preds[0]->next_[0].compare_exchange_strong(expected, aux::link_to(node.get()))) break; // it is in the set now
+        }
+        auto p = node.release();
+        auto linked = [&](int level) { // false once it need not be linked any higher
+            while (true) {
+                auto next = p->next_[level].load();
+                if (aux::marked(next)) return false; // removed already
+                if (aux::unmarked<typename Set::value_type>(next) != succs[level] && !p->next_[level].compare_exchange_strong(next, aux::link_to(succs[level]))) continue;
+                auto expected = aux::link_to(succs[level]);
+                if (preds[level]->next_[level].compare_exchange_strong(expected, aux::link_to(p))) return true;
+                if (!aux::find(set, p->value_, preds, succs) || succs[0] != p) return false;
+            }
+        };
+        for (int level = 1; level < top && linked(level); ++level) {}
+        aux::release(set, p);
+        return true;
+    }
+
+    // Returns false if v has been absent. Marks the node at every level top down; the one marking the lowest level removes it.
+    template <typename V, typename Set, aux::enable_skiplist_t<Set> = 0>
+    bool remove(Set& set, const V& v) {
+        using node_type = typename Set::node_type;
+        node_type* preds[Set::levels];
+        node_type* succs[Set::levels];
+        aux::epoch_guard guard(set);
+        if (!aux::find(set, v, preds, succs)) return false;
+        auto victim = succs[0];
+        for (int level = victim->levels_ - 1; level > 0; --level) {
+            auto next = victim->next_[level].load();
+            while (!aux::marked(next) && !victim->next_[level].compare_exchange_weak(next, next | 1)) {}
+        }
+        auto next = victim->next_[0].load();
+        while (true) {
+            if (aux::marked(next)) return false; // another thread has removed it
+            if (victim->next_[0].compare_exchange_strong(next, next | 1)) break;
+        }
+        aux::release(set, victim); // unlinks it unless its insert is still linking it, which then does
+        return true;
+    }
+
+    // Does not help unlinking removed nodes
+    template <typename V, typename Set, aux::enable_skiplist_t<Set> = 0>
+    bool contains(const Set& set, const V& v) {
+        using value_type = typename Set::value_type;
+        aux::epoch_guard guard(set);
+        auto pred = set.head_;
+        typename Set::node_type* curr = nullptr;
+        for (int level = Set::levels - 1; level >= 0; --level) {
+            curr = aux::unmarked<value_type>(pred->next_[level].load());
+            while (curr) {
+                auto succ = curr->next_[level].load();
+                if (aux::marked(succ)) { // removed: step over it
+                    curr = aux::unmarked<value_type>(succ);
+                    continue;
+                }
+                if (!(curr->value_ < v)) break;
+                pred = curr;
+                curr = aux::unmarked<value_type>(succ);
+            }
+        }
+        return curr && curr->value_ == v;
+    }
+
+    // Forward iterator over the lowest level of a skiplist, skipping removed nodes. It holds elements satisfying a condition only.
+    // It and its copies share a guard, so nodes they might reach are not freed while any of them lives.
+    template <typename T>
+    struct skiplist_iterator {
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        using node_type = aux::skiplist_node<T>;
+        using condition_type = std::function<bool(const value_type&)>;
+
+        skiplist_iterator() = default;
+        skiplist_iterator(const node_type* head, const condition_type& fn, std::shared_ptr<aux::epoch_guard> guard) : node_(head), fn_(fn), guard_(std::move(guard)) {
+            this->step();
+        }
+        skiplist_iterator& operator++() {
+            this->step();
+            return *this;
+        }
+        bool operator==(const skiplist_iterator& other) const {
+            return this->node_ == other.node_;
+        }
+        reference operator*() const {
+            return this->node_->value_;
+        }
+    private:
+        void step() {
+            do this->node_ = aux::unmarked<T>(this->node_->next_[0].load());
+            while (this->node_ && (aux::marked(this->node_->next_[0].load()) || (this->fn_ && !this->fn_(this->node_->value_))));
+        }
+
+        const node_type*                  node_ = nullptr;
+        condition_type                    fn_;
+        std::shared_ptr<aux::epoch_guard> guard_; // the end iterator goes without
+    };
+
+    // A skiplist is a list: traversal is in order only
+    template <typename Tag, typename Set, aux::enable_skiplist_t<Set> = 0, std::enable_if_t<std::is_same_v<std::decay_t<Tag>, tag_inorder>, int> = 0>
+    auto traverse(Tag&&, const Set& set) {
+        using iterator_type = skiplist_iterator<typename Set::value_type>;
+        return iterators<iterator_type>{ iterator_type(set.head_, nullptr, std::make_shared<aux::epoch_guard>(set)), iterator_type() };
+    }
+
+    template <typename Tag, typename Set, aux::enable_skiplist_t<Set> = 0, std::enable_if_t<std::is_same_v<std::decay_t<Tag>, tag_inorder>, int> = 0>
+    auto search(Tag&&, const Set& set, const std::function<bool(const typename Set::value_type&)>& fn) {
+        using iterator_type = skiplist_iterator<typename Set::value_type>;
+        return iterators<iterator_type>{ iterator_type(set.head_, fn, std::make_shared<aux::epoch_guard>(set)), iterator_type() };
+    }
+
+    // O(n); exact only while no one writes
+    template <typename Set, aux::enable_skiplist_t<Set> = 0>
+    size_t size(const Set& set) {
+        size_t n = 0;
+        for (auto i = begin(traverse(tag_inorder{}, set)); i != skiplist_iterator<typename Set::value_type>(); ++i) ++n;
+        return n;
+    }
+
+    // Number of removed nodes not freed yet. Without traversals kept alive it stays below 2 * reclaim_every or so:
+    // an attempt to free leaves what has been removed in the epochs running operations are in.
+    template <typename Set, aux::enable_skiplist_t<Set> = 0>
+    size_t pending(const Set& set) {
+        return set.pending_.load();
+    }
+}
\ No newline at end of file
@@ -30,8 +30,10 @@ namespace tree_search {
                 : augment_type(std::forward<AugPack>(p)...), value_(std::forward<V>(v)), left_(nullptr), right_(nullptr) {}
         };
         
-        template <typename Tree>
+        template <typename Tree, bool Locked = false>
         inline auto&& access(Tree&& tree) { // must be used internally or in tests.
+            static_assert(Locked || !std::is_base_of_v<capability_shared, std::decay_t<Tree>>, // only read() and write() know the lock is held
+                "a tree with capability_shared is used within read() and write() only");
             return tree.root_;
         }
 
@@ -41,6 +43,14 @@ namespace tree_search {
             return 1 + size(tree->left_) + size(tree->right_);
         }
 
+        template <typename T, typename Node>
+        Node* find(const std::unique_ptr<Node>& tree, const T& v) { // plain descent; returns nullptr if v is absent
+            auto ptr = tree.get();
+            while (ptr && !(v == ptr->value_))
+                ptr = v < ptr->value_ ? ptr->left_.get() : ptr->right_.get();
+            return ptr;
+        }
+
         template <typename Node>
         int height(const std::unique_ptr<Node>& tree) {
             if (!tree) return 0;
@@ -71,7 +81,7 @@ namespace tree_search {
     private:
         std::unique_ptr<node_type> root_; // no direct access. if anything, an access must be performed consiously via aux::access
 
-        template <typename Tree>
+        template <typename Tree, bool Locked>
         friend inline auto&& aux::access(Tree&& tree);
     };
 
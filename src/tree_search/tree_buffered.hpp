@@ -0,0 +1,245 @@
+#pragma once
+
+#include "capability_traverse.hpp"
+#include "iterator_aux.hpp"
+#include "tree_bulk_build.hpp"
+#include "type_traverse.hpp"
+
+#include <algorithm> // std::stable_sort, std::inplace_merge, std::unique, std::find, std::binary_search
+#include <cstddef> // size_t
+#include <iterator> // std::forward_iterator_tag
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility> // std::forward, std::move
+#include <vector>
+
+namespace tree_search {
+
+    // Front end for bursty ingest from many threads into one tree. Every producing thread writes through a buffered_writer
+    // of its own, which collects elements in a buffer of its own; a full buffer is sorted and merged into the tree
+    // as one batch by insert_sorted. Producers wait for each other only while a batch is merged, once per batch
+    // rather than once per element.
+    // traverse and contains see the tree along with everything buffered so far.
+    //     tree_search::buffered_tree<rb_tree> ingest(4096 /*elements per batch*/);
+    //     tree_search::buffered_writer<rb_tree> writer(ingest); // one per producing thread
+    //     insert(writer, 42);
+    template <typename Tree>
+    struct buffered_tree {
+        using tree_type = Tree;
+        using value_type = aux::value_type_t<Tree>;
+
+        struct buffer {
+            std::mutex              mutex_;      // its writer takes it for a moment per element; views and flushes hold it longer
+            std::vector<value_type> values_;
+            size_t                  sorted_ = 0; // values_ are sorted up to here, elements appended since are not
+        };
+
+        explicit buffered_tree(size_t batch = 4096) : batch_(batch) {}
+        buffered_tree(const buffered_tree&) = delete;
+        buffered_tree& operator=(const buffered_tree&) = delete;
+
+        size_t                               batch_;
+        mutable std::shared_mutex            buffers_mutex_; // taken exclusively only to add or drop a buffer
+        std::vector<std::unique_ptr<buffer>> buffers_;
+        mutable std::shared_mutex            mutex_;         // of the tree. buffers are always locked before it
+        Tree                                 tree_;
+    };
+
+    // Writing side of a buffered_tree for one thread. Whatever is left in its buffer is merged when it goes.
+    template <typename Tree>
+    struct buffered_writer {
+        using buffer_type = typename buffered_tree<Tree>::buffer;
+
+        explicit buffered_writer(buffered_tree<Tree>& tree) : tree_(tree) {
+            std::unique_ptr<buffer_type> b(new buffer_type());
+            b->values_.reserve(tree.batch_);
+            this->buffer_ = b.get();
+            std::unique_lock<std::shared_mutex> lock(tree.buffers_mutex_);
+            tree.buffers_.push_back(std::move(b));
+        }
+        buffered_writer(const buffered_writer&) = delete;
+        buffered_writer& operator=(const buffered_writer&) = delete;
+        ~buffered_writer();
+
+        buffered_tree<Tree>& tree_;
+        buffer_type*         buffer_ = nullptr;
+    };
+
+    namespace aux {
+
+        template <typename Tree>
+        struct is_buffered : std::false_type {};
+
+        template <typename Tree>
+        struct is_buffered<buffered_tree<Tree>> : std::true_type {};
+
+        template <typename Tree>
+        using enable_buffered_t = std::enable_if_t<is_buffered<std::decay_t<Tree>>::value, int>;
+
+        // Sorts what has been appended since the last time and merges it with the sorted part. The buffer must be locked.
+        // Both steps are stable, so of equal elements the one appended first comes first.
+        template <typename Buffer>
+        void sort_buffer(Buffer& b) {
+            auto&& v = b.values_;
+            std::stable_sort(v.begin() + b.sorted_, v.end());
+            std::inplace_merge(v.begin(), v.begin() + b.sorted_, v.end());
+            b.sorted_ = v.size();
+        }
+
+        // Merges a buffer into the tree as one batch
+        template <typename Tree, typename Buffer>
+        void flush(buffered_tree<Tree>& tree, Buffer& b) {
+            std::unique_lock<std::mutex> lock(b.mutex_);
+            if (b.values_.empty()) return;
+            sort_buffer(b);
+            b.values_.erase(std::unique(b.values_.begin(), b.values_.end()), b.values_.end());
+            {
+                std::unique_lock<std::shared_mutex> tree_lock(tree.mutex_);
+                insert_sorted(tree.tree_, b.values_);
+            }
+            b.values_.clear();
+            b.sorted_ = 0;
+        }
+    }
+
+    template <typename Tree>
+    buffered_writer<Tree>::~buffered_writer() {
+        aux::flush(this->tree_, *this->buffer_);
+        std::unique_lock<std::shared_mutex> lock(this->tree_.buffers_mutex_);
+        auto&& buffers = this->tree_.buffers_;
+        buffers.erase(std::find_if(buffers.begin(), buffers.end(), [this](auto& b) { return b.get() == this->buffer_; }));
+    }
+
+    // Appends to the buffer of the writer; a full one is merged into the tree right away.
+    // An element already in the tree or buffered stays as it is, as insert keeps it.
+    template <typename T, typename Tree>
+    void insert(buffered_writer<Tree>& writer, T&& v) {
+        auto&& b = *writer.buffer_;
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(b.mutex_);
+            b.values_.emplace_back(std::forward<T>(v));
+            full = b.values_.size() >= writer.tree_.batch_;
+        }
+        if (full) aux::flush(writer.tree_, b);
+    }
+
+    // Merges what the writer has buffered into the tree
+    template <typename Tree>
+    void flush(buffered_writer<Tree>& writer) {
+        aux::flush(writer.tree_, *writer.buffer_);
+    }
+
+    // Merges every buffer into the tree, one batch per buffer
+    template <typename Tree, aux::enable_buffered_t<Tree> = 0>
+    void flush(Tree& tree) {
+        std::shared_lock<std::shared_mutex> lock(tree.buffers_mutex_);
+        for (auto&& b : tree.buffers_) aux::flush(tree, *b);
+    }
+
+    // Number of elements buffered but not merged yet, duplicates included
+    template <typename Tree, aux::enable_buffered_t<Tree> = 0>
+    size_t pending(const Tree& tree) {
+        std::shared_lock<std::shared_mutex> lock(tree.buffers_mutex_);
+        size_t n = 0;
+        for (auto&& b : tree.buffers_) {
+            std::lock_guard<std::mutex> buffer_lock(b->mutex_);
+            n += b->values_.size();
+        }
+        return n;
+    }
+
+    // Forward iterator merging the tree in order with sorted buffers. An element found in several places comes once,
+    // the one of the tree first of all.
+    template <typename It, typename T>
+    struct buffered_iterator {
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        struct run {
+            const value_type* cur_;
+            const value_type* end_;
+        };
+
+        buffered_iterator() = default;
+        buffered_iterator(It it, It end, std::vector<run> runs) : it_(it), end_(end), runs_(std::move(runs)) {
+            this->pick();
+        }
+        buffered_iterator& operator++() {
+            auto&& v = *this->current_; // stays in place: neither the tree nor the buffers change while the view lives
+            if (this->it_ != this->end_ && *this->it_ == v) ++this->it_;
+            for (auto&& r : this->runs_)
+                while (r.cur_ != r.end_ && *r.cur_ == v) ++r.cur_;
+            this->pick();
+            return *this;
+        }
+        bool operator==(const buffered_iterator& other) const {
+            return this->current_ == other.current_;
+        }
+        reference operator*() const {
+            return *this->current_;
+        }
+    private:
+        void pick() { // the least of the fronts
+            this->current_ = this->it_ != this->end_ ? &*this->it_ : nullptr;
+            for (auto&& r : this->runs_)
+                if (r.cur_ != r.end_ && (!this->current_ || *r.cur_ < *this->current_)) this->current_ = r.cur_;
+        }
+
+        It                it_ = {};
+        It                end_ = {};
+        std::vector<run>  runs_;
+        const value_type* current_ = nullptr; // nullptr at the end
+    };
+
+    // Merged view of a buffered tree. It holds every buffer and read access to the tree for as long as it lives,
+    // so it sees one consistent state; writers wait for it to go.
+    template <typename Tree>
+    struct buffered_iterators
+        : public iterators<buffered_iterator<decltype(traverse(tag_inorder{}, std::declval<const Tree&>()).begin_), aux::value_type_t<Tree>>> {
+        using tree_iterator = decltype(traverse(tag_inorder{}, std::declval<const Tree&>()).begin_);
+        using iterator_type = buffered_iterator<tree_iterator, aux::value_type_t<Tree>>;
+
+        explicit buffered_iterators(const buffered_tree<Tree>& tree) : buffers_lock_(tree.buffers_mutex_) {
+            std::vector<typename iterator_type::run> runs;
+            for (auto&& b : tree.buffers_) {
+                this->locks_.emplace_back(b->mutex_);
+                aux::sort_buffer(*b);
+                runs.push_back({ b->values_.data(), b->values_.data() + b->values_.size() });
+            }
+            this->tree_lock_ = std::shared_lock<std::shared_mutex>(tree.mutex_);
+            auto r = traverse(tag_inorder{}, tree.tree_);
+            this->begin_ = iterator_type(r.begin_, r.end_, std::move(runs));
+            this->end_ = iterator_type();
+        }
+    private:
+        std::shared_lock<std::shared_mutex>       buffers_lock_;
+        std::vector<std::unique_lock<std::mutex>> locks_;
+        std::shared_lock<std::shared_mutex>       tree_lock_;
+    };
+
+    // The tree along with everything buffered, in order
+    template <typename Tag, typename Tree, aux::enable_buffered_t<Tree> = 0, std::enable_if_t<std::is_same_v<std::decay_t<Tag>, tag_inorder>, int> = 0>
+    auto traverse(Tag&&, const Tree& tree) {
+        return buffered_iterators<typename Tree::tree_type>(tree);
+    }
+
+    template <typename T, typename Tree, aux::enable_buffered_t<Tree> = 0>
+    bool contains(const Tree& tree, const T& v) {
+        std::shared_lock<std::shared_mutex> lock(tree.buffers_mutex_);
+        for (auto&& b : tree.buffers_) {
+            std::lock_guard<std::mutex> buffer_lock(b->mutex_);
+            auto&& values = b->values_;
+            auto tail = values.begin() + b->sorted_; // the sorted part is searched in O(log n), what is appended since is scanned
+            if (std::binary_search(values.begin(), tail, v) || std::find(tail, values.end(), v) != values.end()) return true;
+        }
+        std::shared_lock<std::shared_mutex> tree_lock(tree.mutex_);
+        return aux::find(aux::access(tree.tree_), v) != nullptr;
+    }
+}
\ No newline at end of file
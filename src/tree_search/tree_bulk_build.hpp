@@ -0,0 +1,209 @@
+/* Additional material
+- Blelloch, Ferizovic, Sun. Just Join for Parallel Ordered Sets https://arxiv.org/abs/1602.02120
+- Cormen, Leiserson, Rivest, Stein. Introduction to Algorithms, 27.3 Multithreaded merge sort
+*/
+#pragma once
+
+#include "tree.hpp"
+#include "tree_set_operations.hpp"
+#include "tree_split_join.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::sort, std::stable_sort, std::merge, std::lower_bound, std::upper_bound, std::move
+#include <cstddef> // size_t
+#include <future> // std::async
+#include <iterator> // std::make_move_iterator
+#include <memory> // std::unique_ptr
+#include <utility> // std::forward, std::move
+#include <vector>
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Fewer elements than that are not worth a task of their own
+        constexpr size_t bulk_grain = 1 << 13;
+
+        // Merges two sorted runs into out. The larger run is cut at its middle and the smaller one where the middle would go,
+        // so both halves are merged independently. Equal elements of the first run stay in front of the ones of the second.
+        template <typename T>
+        void parallel_merge(T* a, T* a_end, T* b, T* b_end, T* out, int forks) {
+            auto n = static_cast<size_t>((a_end - a) + (b_end - b));
+            if (forks <= 0 || n < bulk_grain) {
+                std::merge(std::make_move_iterator(a), std::make_move_iterator(a_end), std::make_move_iterator(b), std::make_move_iterator(b_end), out);
+                return;
+            }
+            T* am;
+            T* bm;
+            if (a_end - a >= b_end - b) {
+                am = a + (a_end - a) / 2;
+                bm = std::lower_bound(b, b_end, *am);
+            }
+            else {
+                bm = b + (b_end - b) / 2;
+                am = std::upper_bound(a, a_end, *bm);
+            }
+            auto mid = out + (am - a) + (bm - b);
+            fork_join(true,
+                [&] { parallel_merge(a, am, b, bm, out, forks - 1); return 0; },
+                [&] { parallel_merge(am, a_end, bm, b_end, mid, forks - 1); return 0; });
+        }
+
+        // Stable merge sort of [lo, hi) of 'a' leaving the result either in 'a' or in the same positions of 'spare'.
+        // Halves are sorted into the other array, so every level merges from one array into the other without copying back.
+        template <typename T>
+        void parallel_sort(std::vector<T>& a, std::vector<T>& spare, size_t lo, size_t hi, int forks, bool to_spare) {
+            if (forks <= 0 || hi - lo < bulk_grain) {
+                std::stable_sort(a.begin() + lo, a.begin() + hi);
+                if (to_spare) std::move(a.begin() + lo, a.begin() + hi, spare.begin() + lo);
+                return;
+            }
+            auto mid = lo + (hi - lo) / 2;
+            fork_join(true,
+                [&] { parallel_sort(a, spare, lo, mid, forks - 1, !to_spare); return 0; },
+                [&] { parallel_sort(a, spare, mid, hi, forks - 1, !to_spare); return 0; });
+            auto&& from = to_spare ? a : spare;
+            auto&& to = to_spare ? spare : a;
+            parallel_merge(from.data() + lo, from.data() + mid, from.data() + mid, from.data() + hi, to.data() + lo, forks);
+        }
+
+        // Moves the first of every run of equal elements of sorted 'from' to the front of 'to'. Returns their number.
+        // Chunks are counted in parallel first, so each one knows where its elements go, and then moved in parallel.
+        template <typename T>
+        size_t parallel_unique(std::vector<T>& from, std::vector<T>& to, int forks) {
+            auto n = from.size();
+            size_t chunks = std::max<size_t>(1, std::min<size_t>(size_t(1) << std::max(forks, 0), n / bulk_grain));
+            auto first = [&](size_t c) { return n * c / chunks; };
+            auto kept = [&](size_t i) { return i == 0 || !(from[i - 1] == from[i]); };
+            std::vector<size_t> offsets(chunks + 1, 0);
+            std::vector<char> head_kept(chunks, 0); // the first element of a chunk looks into the previous chunk, which is moved meanwhile
+            auto count_chunk = [&](size_t c) {
+                if (first(c) == first(c + 1)) return;
+                head_kept[c] = kept(first(c));
+                for (auto i = first(c); i != first(c + 1); ++i) offsets[c + 1] += kept(i) ? 1 : 0;
+            };
+            auto move_chunk = [&](size_t c) { // backwards, so the neighbour to the left has not been moved yet
+                auto out = offsets[c + 1];
+                for (auto i = first(c + 1); i-- != first(c); )
+                    if (i == first(c) ? head_kept[c] != 0 : kept(i)) to[--out] = std::move(from[i]);
+            };
+            auto for_chunks = [&](auto&& pass) {
+                std::vector<std::future<void>> tasks;
+                for (size_t c = 1; c < chunks; ++c) tasks.push_back(std::async(std::launch::async, [&, c] { pass(c); }));
+                pass(0);
+                for (auto&& t : tasks) t.get();
+            };
+            for_chunks(count_chunk);
+            for (size_t c = 0; c != chunks; ++c) offsets[c + 1] += offsets[c];
+            for_chunks(move_chunk);
+            return offsets[chunks];
+        }
+
+        // A node to be joined. Interval nodes start their aggregates with the end of the interval.
+        template <typename Node, typename T, typename Tag>
+        std::unique_ptr<Node> detached_node(T&& v, Tag) {
+            return std::make_unique<Node>(std::forward<T>(v));
+        }
+
+        template <typename Node, typename T>
+        std::unique_ptr<Node> detached_node(T&& v, capability_remove_interval) {
+            auto end = end_of(v);
+            return std::make_unique<Node>(std::forward<T>(v), end);
+        }
+
+        // Builds a tree of sorted distinct [lo, hi) taking the middle as the root. Halves are built independently
+        // and stitched together by join, which gives colors, heights and aggregates for whatever balancing the tree uses;
+        // halves differ in rank by at most one, so every join is O(1) and the whole build is O(n) work.
+        template <typename Node, typename T, typename Tag>
+        ranked<Node> build_sorted(std::vector<T>& values, size_t lo, size_t hi, int forks, Tag tag) {
+            if (lo == hi) return empty<Node>(tag);
+            auto mid = lo + (hi - lo) / 2;
+            auto lr = fork_join(forks > 0 && hi - lo >= bulk_grain,
+                [&] { return build_sorted<Node>(values, lo, mid, forks - 1, tag); },
+                [&] { return build_sorted<Node>(values, mid + 1, hi, forks - 1, tag); });
+            auto m = detached_node<Node>(std::move(values[mid]), tag);
+            return join(std::move(lr.first.tree_), lr.first.rank_, std::move(m), std::move(lr.second.tree_), lr.second.rank_, tag);
+        }
+
+        // Union of a tree with sorted distinct [lo, hi) as union_of does it, with the elements cut by binary searches
+        // rather than by splits of a tree of them. Where a run of them falls into an empty subtree it is built as a whole.
+        // Of equal elements the one of the tree is kept.
+        template <typename Node, typename T, typename Tag>
+        ranked<Node> union_sorted(ranked<Node> a, std::vector<T>& values, size_t lo, size_t hi, int forks, Tag tag) {
+            if (lo == hi) return a;
+            if (!a.tree_) return build_sorted<Node>(values, lo, hi, forks, tag);
+            auto parallel = forks > 0 && a.rank_ >= parallel_rank(tag) && hi - lo >= bulk_grain;
+            auto rl = child_rank(*a.tree_, a.rank_, a.tree_->left_, tag);
+            auto rr = child_rank(*a.tree_, a.rank_, a.tree_->right_, tag);
+            auto m = std::move(a.tree_);
+            auto less = static_cast<size_t>(std::lower_bound(values.begin() + lo, values.begin() + hi, m->value_) - values.begin());
+            auto greater = less != hi && values[less] == m->value_ ? less + 1 : less;
+            auto lr = fork_join(parallel,
+                [&] { return union_sorted(ranked<Node>{ std::move(m->left_), rl }, values, lo, less, forks - 1, tag); },
+                [&] { return union_sorted(ranked<Node>{ std::move(m->right_), rr }, values, greater, hi, forks - 1, tag); });
+            return join(std::move(lr.first.tree_), lr.first.rank_, std::move(m), std::move(lr.second.tree_), lr.second.rank_, tag);
+        }
+    }
+
+    namespace aux {
+
+        // Sorted distinct elements of a range given in any order, by a parallel merge sort and parallel removal of duplicates.
+        // Of equal elements the first one is kept.
+        template <typename T, typename It>
+        std::vector<T> sorted_distinct(It begin, It end, int forks) {
+            std::vector<T> values(begin, end);
+            std::vector<T> spare(values.size());
+            parallel_sort(values, spare, 0, values.size(), forks, false);
+            spare.resize(parallel_unique(values, spare, forks));
+            return spare;
+        }
+    }
+
+    // Builds a tree of elements given in any order: a parallel merge sort, parallel removal of duplicates and
+    // a parallel build of balanced subtrees joined together. O(n log n) work and O(log^2 n) span against
+    // n inserts one after another. Of equal elements the first one is kept, as inserting them one by one would do.
+    // Elements must be default constructible and move assignable.
+    //     auto bin = tree_search::bulk_build<avl_tree>(keys.begin(), keys.end());
+    template <typename Tree, typename It, aux::enable_split_join_t<Tree> = 0>
+    Tree bulk_build(It begin, It end) {
+        auto tag = aux::split_tag_t<Tree>{};
+        auto forks = aux::fork_depth();
+        auto values = aux::sorted_distinct<aux::value_type_t<Tree>>(begin, end, forks);
+        Tree res;
+        if constexpr (aux::is_counted<Tree>::value) {
+            std::vector<decltype(aux::end_key_of(values.front()))> ends;
+            for (auto&& v : values) ends.push_back(aux::end_key_of(v));
+            res.ends_ = bulk_build<decltype(res.ends_)>(ends.begin(), ends.end());
+        }
+        aux::access(res) = aux::build_sorted<aux::node_type_t<Tree>>(values, 0, values.size(), forks, tag).tree_;
+        aux::blacken_root(aux::access(res), tag);
+        return res;
+    }
+
+    // Inserts sorted distinct elements, moving them out of 'values'. Every subtree is descended once for all the elements
+    // that go into it, and subtrees are rebalanced by joins on the way back: O(m log(n/m + 1)) against m inserts of O(log n) each.
+    // Elements present in the tree are kept, as insert keeps them.
+    template <typename Tree, aux::enable_split_join_t<Tree> = 0>
+    void insert_sorted(Tree& tree, std::vector<aux::value_type_t<Tree>>& values) {
+        auto tag = aux::split_tag_t<Tree>{};
+        auto&& root = aux::access(tree);
+        if constexpr (aux::is_counted<Tree>::value) { // the ends of the elements the tree does not hold yet, in order as the ends are distinct
+            std::vector<decltype(aux::end_key_of(values.front()))> ends;
+            for (auto&& v : values)
+                if (!aux::find(root, v)) ends.push_back(aux::end_key_of(v));
+            std::sort(ends.begin(), ends.end());
+            insert_sorted(tree.ends_, ends);
+        }
+        auto r = aux::rank(root, tag);
+        root = aux::union_sorted(aux::ranked<aux::node_type_t<Tree>>{ std::move(root), r }, values, 0, values.size(), aux::fork_depth(), tag).tree_;
+        aux::blacken_root(root, tag);
+    }
+
+    // Inserts elements given in any order into a tree which might hold elements already: they are sorted as bulk_build does it
+    // and inserted by insert_sorted
+    template <typename Tree, typename It, aux::enable_split_join_t<Tree> = 0>
+    void bulk_insert(Tree& tree, It begin, It end) {
+        auto values = aux::sorted_distinct<aux::value_type_t<Tree>>(begin, end, aux::fork_depth());
+        insert_sorted(tree, values);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/* Additional material
+- Cormen, Leiserson, Rivest, Stein. Introduction to Algorithms, 14.3 Interval trees (augmenting any balanced tree)
+*/
+#pragma once
+
+#include "tree_avl.hpp"
+#include "tree_interval.hpp"
+#include "capability_insert.hpp"
+#include "capability_remove.hpp"
+#include "type_capability.hpp"
+#include "type_cti.hpp"
+
+#include <memory> // std::unique_ptr
+#include <type_traits>
+
+namespace tree_search {
+
+    // Interval tree balanced as an AVL tree. Its height is at most ~1.44 log n against ~2 log n of the red-black one,
+    // so queries take fewer steps down the tree at the cost of more rotations on updates. Searching and counting are shared
+    // with interval_augment through capability_search_interval.
+    template <typename Interval, typename Node>
+    struct interval_avl_augment
+        : public avl_augment<Interval, Node>
+        , public interval_aggregates<Interval> {
+        using base_type = typename interval_aggregates<Interval>::base_type;
+
+        template <typename U = base_type>
+        explicit interval_avl_augment(U&& u) : interval_aggregates<Interval>(std::forward<U>(u)) {}
+    };
+
+    namespace aux {
+
+        // called from capability_insert/capability_remove. rotations restore the nodes they move (see rotated), the node on the path is left
+        template <typename Node, typename Tag, std::enable_if_t<is_one_of_v<Tag, capability_insert_interval_avl, capability_remove_interval_avl>, int> = 0>
+        void fixup(std::unique_ptr<Node>& tree, Tag) {
+            aux::fixup(tree, capability_insert_avl{});
+            update_aggregates(tree);
+        }
+
+        template <typename T, typename Tree, typename Capability>
+        using enable_interval_avl_t =
+            std::enable_if_t< std::is_base_of_v<Capability, Tree>
+                            && std::is_same_v<augment_type_t<Tree>, interval_avl_augment<std::decay_t<T>, node_type_t<Tree>>> // only for interval_avl_augment
+                            && !std::is_base_of_v<capability_rotate, Tree> // rotation available on a user side may invalidate invariants
+            , int>;
+    }
+
+    template <typename T, typename Tree, aux::enable_interval_avl_t<T, Tree, capability_insert_interval_avl> = 0>
+    void insert(Tree& tree, T&& v) { // universal reference
+        aux::index_change<Tree> change(tree, v);
+        aux::insert(aux::access(tree), capability_insert_interval_avl{}, std::forward<T>(v), aux::end_of(v));
+        change.commit(tree);
+    }
+
+    template <typename T, typename Tree, aux::enable_interval_avl_t<T, Tree, capability_insert_interval_avl> = 0>
+    void insert(Tree& tree, std::initializer_list<T> ls) {
+        for (auto&& v : ls) insert(tree, std::move(v));
+    }
+
+    template <typename It, typename Tree, std::enable_if_t<std::is_base_of_v<capability_insert_interval_avl, Tree>, int> = 0>
+    void insert(Tree& tree, It begin, It end) {
+        while (begin != end) insert(tree, *begin++);
+    }
+
+    template <typename T, typename Tree, aux::enable_interval_avl_t<T, Tree, capability_remove_interval_avl> = 0>
+    void remove(Tree& tree, const T& v) {
+        aux::index_change<Tree> change(tree, v);
+        aux::remove(aux::access(tree), v, capability_remove_interval_avl{});
+        change.commit(tree);
+    }
+
+    template <typename T, typename Tree, aux::enable_interval_avl_t<T, Tree, capability_remove_interval_avl> = 0>
+    void remove(Tree& tree, std::initializer_list<T> ls) {
+        for (auto&& v : ls) remove(tree, v);
+    }
+
+    template <typename It, typename Tree, std::enable_if_t<std::is_base_of_v<capability_remove_interval_avl, Tree>, int> = 0>
+    void remove(Tree& tree, It begin, It end) {
+        while (begin != end) remove(tree, *begin++);
+    }
+}
\ No newline at end of file
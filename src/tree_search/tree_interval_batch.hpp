@@ -0,0 +1,70 @@
+#pragma once
+
+#include "capability_search_interval.hpp"
+#include "tree_interval.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::partition_point, std::stable_sort
+#include <cstddef> // size_t
+#include <future> // std::async
+#include <memory> // std::unique_ptr
+#include <vector>
+
+namespace tree_search {
+
+    namespace aux {
+
+        // One traversal answers a whole run of queries sorted by their start. Every subtree is entered once
+        // for all the queries that might overlap it rather than once per query.
+        // The run is at the bottom of 'run'; the queries going on to a right subtree are pushed on top of it for as long
+        // as that subtree is searched, so a run of queries takes one buffer rather than one per node.
+        template <typename Node, typename Interval, typename Out>
+        void search_batch(const std::unique_ptr<Node>& tree, const std::vector<Interval>& queries, std::vector<size_t>& run, size_t first, size_t last, Out& out) {
+            using interval_type = typename Node::value_type;
+            if (!tree) return;
+            // queries starting after the greatest end of the subtree miss it. being sorted, they are the suffix of the run
+            last = std::partition_point(run.begin() + first, run.begin() + last, [&](size_t q) { return !ends_before<interval_type>(tree->max_, start_of(queries[q])); }) - run.begin();
+            if (first == last) return;
+            search_batch(tree->left_, queries, run, first, last, out);
+            auto top = run.size();
+            for (auto i = first; i != last; ++i) {
+                auto q = run[i]; // by value, pushing might move the buffer
+                auto&& v = queries[q];
+                if (starts_after<interval_type>(start_of(tree->value_), end_of(v))) continue; // ends before the current start, and so before the right subtree
+                if (!ends_before<interval_type>(end_of(tree->value_), start_of(v))) out[q].push_back(tree->value_);
+                if (tree->right_) run.push_back(q);
+            }
+            search_batch(tree->right_, queries, run, top, run.size(), out);
+            run.resize(top);
+        }
+    }
+
+    // Answers a batch of overlap queries. Results are grouped per query in the order the queries are given,
+    // matches of every query come in order. Queries are sorted by their start internally, so the batch might be given in any order;
+    // the sorted batch is cut into contiguous runs, one per thread, and each run is answered by a single traversal.
+    template <typename Interval, typename Tree, aux::enable_interval_query_t<Tree> = 0>
+    std::vector<std::vector<aux::value_type_t<Tree>>> search_batch(const Tree& tree, const std::vector<Interval>& queries, size_t threads = 1) {
+        std::vector<size_t> order;
+        order.reserve(queries.size());
+        for (size_t q = 0; q != queries.size(); ++q)
+            if (!aux::empty_interval<aux::value_type_t<Tree>>(aux::start_of(queries[q]), aux::end_of(queries[q]))) order.push_back(q); // an empty query matches nothing
+        std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) { return aux::start_of(queries[l]) < aux::start_of(queries[r]); });
+
+        std::vector<std::vector<aux::value_type_t<Tree>>> res(queries.size());
+        threads = std::max<size_t>(1, std::min(threads, order.size()));
+        auto run = (order.size() + threads - 1) / threads;
+        auto&& root = aux::access(tree);
+        std::vector<std::future<void>> tasks;
+        auto search = [&](size_t first, size_t last) {
+            std::vector<size_t> buffer;
+            buffer.reserve(2 * (last - first)); // grows only if paths turn right often with many queries left
+            buffer.assign(order.begin() + first, order.begin() + last);
+            aux::search_batch(root, queries, buffer, 0, buffer.size(), res);
+        };
+        for (size_t t = 1; t < threads; ++t) // every run writes into its own queries' slots only
+            tasks.push_back(std::async(std::launch::async, search, std::min(order.size(), t * run), std::min(order.size(), (t + 1) * run)));
+        search(0, std::min(order.size(), run));
+        for (auto&& t : tasks) t.get();
+        return res;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "capability_search_interval.hpp"
+#include "tree_interval.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::max
+#include <limits>
+#include <memory> // std::unique_ptr
+#include <type_traits>
+
+namespace tree_search {
+
+    // Interval tree augment which also keeps the measure covered by the union of the subtree's intervals.
+    // Bounds must be arithmetic: the length of an interval is end - start, whether it is closed or half-open.
+    //     using tree = tree_search::tree<std::pair<double, double>, tree_search::interval_coverage_augment, tree_search::capability_insert_interval, ...>;
+    template <typename Interval, typename Node>
+    struct interval_coverage_augment
+        : public interval_augment<Interval, Node> {
+        using base_type = typename interval_augment<Interval, Node>::base_type;
+        base_type   cover_ = {}; // measure of the union of the intervals within the subtree
+
+        template <typename U = base_type>
+        explicit interval_coverage_augment(U&& u) : interval_augment<Interval, Node>(std::forward<U>(u)) {}
+    };
+
+    namespace aux {
+
+        template <typename Tree>
+        using has_coverage = std::is_base_of<interval_coverage_augment<value_type_t<Tree>, node_type_t<Tree>>, augment_type_t<Tree>>;
+
+        template <typename T>
+        constexpr T no_end() { return std::numeric_limits<T>::lowest(); } // the greatest end before the first interval
+
+        // Measure an interval adds to the union of the intervals before it, the greatest end of which is m
+        template <typename Interval, typename T>
+        T added_length(const Interval& v, const T& m) {
+            auto from = std::max(m, start_of(v));
+            return from < end_of(v) ? end_of(v) - from : T{};
+        }
+
+        // Measure the intervals of a subtree add to the union of the intervals before them, the greatest end of which is m.
+        // One path down: once m reaches the ends of the left subtree and the root, those add nothing. Otherwise the right
+        // subtree sees the same greatest end as it does within the node, so what it adds is known from cover_.
+        template <typename Node, typename T>
+        T covered_after(const std::unique_ptr<Node>& tree, const T& m) {
+            if (!tree || !(m < tree->max_)) return T{};
+            auto lmax = tree->left_ ? tree->left_->max_ : no_end<T>();
+            if (!(m < std::max(lmax, end_of(tree->value_)))) return covered_after(tree->right_, m);
+            auto lcover = tree->left_ ? tree->left_->cover_ : T{};
+            auto right = tree->cover_ - lcover - added_length(tree->value_, lmax);
+            return covered_after(tree->left_, m) + added_length(tree->value_, std::max(m, lmax)) + right;
+        }
+
+        // called from update_aggregates for every node whose children are up to date. O(log n), as the right subtree is
+        // descended once, so updates take O(log^2 n) overall
+        template <typename Node, std::enable_if_t<has_coverage<Node>::value, int> = 0>
+        void update_more_aggregates(std::unique_ptr<Node>& tree) {
+            using bound_type = typename Node::base_type;
+            auto lmax = tree->left_ ? tree->left_->max_ : no_end<bound_type>();
+            auto lcover = tree->left_ ? tree->left_->cover_ : bound_type{};
+            tree->cover_ = lcover + added_length(tree->value_, lmax) + covered_after(tree->right_, std::max(lmax, end_of(tree->value_)));
+        }
+
+        // Measure of the union within (-inf, x]. Intervals starting after x lie beyond it. Those starting not after x
+        // are summed up along one path; what of them lies beyond x is [x, greatest end], covered without gaps.
+        template <typename Node, typename T>
+        T covered_up_to(const std::unique_ptr<Node>& tree, const T& x) {
+            T sum{};
+            auto m = no_end<T>();
+            for (auto p = tree.get(); p; ) {
+                if (x < start_of(p->value_)) {
+                    p = p->left_.get();
+                    continue;
+                }
+                sum += covered_after(p->left_, m);
+                if (p->left_) m = std::max(m, p->left_->max_);
+                sum += added_length(p->value_, m);
+                m = std::max(m, end_of(p->value_));
+                p = p->right_.get();
+            }
+            return x < m ? sum - (m - x) : sum;
+        }
+
+        template <typename Tree>
+        using enable_coverage_t = std::enable_if_t<std::is_base_of_v<capability_search_interval, Tree> && has_coverage<Tree>::value, int>;
+    }
+
+    // Measure covered by the union of all intervals in O(1)
+    template <typename Tree, aux::enable_coverage_t<Tree> = 0>
+    auto covered_length(const Tree& tree) {
+        using bound_type = typename interval_traits<aux::value_type_t<Tree>>::bound_type;
+        auto&& root = aux::access(tree);
+        return root ? root->cover_ : bound_type{};
+    }
+
+    // Measure covered by the union of all intervals within the window in O(log^2 n)
+    template <typename Interval, typename Tree, aux::enable_coverage_t<Tree> = 0>
+    auto covered_length(const Tree& tree, const Interval& window) {
+        using bound_type = typename interval_traits<aux::value_type_t<Tree>>::bound_type;
+        bound_type a = aux::start_of(window);
+        bound_type b = aux::end_of(window);
+        if (!(a < b)) return bound_type{};
+        auto&& root = aux::access(tree);
+        return aux::covered_up_to(root, b) - aux::covered_up_to(root, a);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "capability_search_interval.hpp"
+#include "tree_split_join.hpp"
+#include "tree_interval.hpp"
+#include "type_cti.hpp"
+
+#include <memory> // std::unique_ptr
+#include <utility> // std::move
+#include <vector>
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Filters a subtree of a given rank by join: what remains of both children is joined back around the root,
+        // or without it if the root overlaps [a, b]. Subtrees ending before a or starting after b are kept as a whole,
+        // so k removals out of n take O(k log(n/k + 1)) work and the tree is rebalanced by joins only.
+        // Removed intervals are moved into 'out' in order.
+        template <typename Node, typename T, typename Tag>
+        ranked<Node> erase_overlapping(std::unique_ptr<Node> tree, int tree_rank, const T& a, const T& b, std::vector<typename Node::value_type>& out, Tag tag) {
+            using interval_type = typename Node::value_type;
+            if (!tree || ends_before<interval_type>(tree->max_, a)) return { std::move(tree), tree_rank };
+            auto rl = child_rank(*tree, tree_rank, tree->left_, tag);
+            auto rr = child_rank(*tree, tree_rank, tree->right_, tag);
+            auto l = erase_overlapping(std::move(tree->left_), rl, a, b, out, tag);
+            auto r = std::move(tree->right_);
+            if (starts_after<interval_type>(start_of(tree->value_), b)) // so does everything to the right of the root
+                return join(std::move(l.tree_), l.rank_, std::move(tree), std::move(r), rr, tag);
+
+            auto overlaps = !ends_before<interval_type>(end_of(tree->value_), a);
+            if (overlaps) out.push_back(std::move(tree->value_));
+            auto g = erase_overlapping(std::move(r), rr, a, b, out, tag);
+            if (overlaps) return join(std::move(l), std::move(g), tag); // the node is released here
+            return join(std::move(l.tree_), l.rank_, std::move(tree), std::move(g.tree_), g.rank_, tag);
+        }
+    }
+
+    // Removes every interval overlapping the window in one pass and returns them in order, moved out of the tree.
+    // The tree is rebalanced by joins on the way back up rather than by a fixup per removal.
+    template <typename Interval, typename Tree, aux::enable_split_join_t<Tree> = 0, aux::enable_interval_query_t<Tree> = 0>
+    std::vector<aux::value_type_t<Tree>> erase_overlapping(Tree& tree, const Interval& window) {
+        using interval_type = aux::value_type_t<Tree>;
+        using bound_type = typename interval_traits<interval_type>::bound_type;
+        std::vector<interval_type> removed;
+        bound_type a = aux::start_of(window);
+        bound_type b = aux::end_of(window);
+        if (aux::empty_interval<interval_type>(a, b)) return removed;
+        auto tag = aux::split_tag_t<Tree>{};
+        auto&& root = aux::access(tree);
+        auto r = aux::rank(root, tag);
+        root = aux::erase_overlapping(std::move(root), r, a, b, removed, tag).tree_;
+        aux::blacken_root(root, tag);
+        if constexpr (aux::is_counted<Tree>::value)
+            for (auto&& v : removed) remove(tree.ends_, aux::end_key_of(v));
+        return removed;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "capability_search_interval.hpp"
+#include "tree_interval.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::max
+#include <limits>
+#include <memory> // std::unique_ptr
+#include <type_traits>
+
+namespace tree_search {
+
+    // Interval tree augment which also keeps the free gaps between the intervals of a subtree, e.g. of a calendar.
+    // A gap before an interval is its start less the greatest end of the intervals before it. Bounds must be arithmetic.
+    //     using tree = tree_search::tree<std::pair<int, int>, tree_search::interval_gap_augment, tree_search::capability_insert_interval, ...>;
+    template <typename Interval, typename Node>
+    struct interval_gap_augment
+        : public interval_augment<Interval, Node> {
+        using base_type = typename interval_augment<Interval, Node>::base_type;
+        base_type   gap_ = std::numeric_limits<base_type>::lowest();       // the largest gap between intervals within the subtree
+        base_type   right_gap_ = std::numeric_limits<base_type>::lowest(); // the largest gap within the right subtree, as seen from the node
+
+        template <typename U = base_type>
+        explicit interval_gap_augment(U&& u) : interval_augment<Interval, Node>(std::forward<U>(u)) {}
+    };
+
+    namespace aux {
+
+        template <typename Tree>
+        using has_gaps = std::is_base_of<interval_gap_augment<value_type_t<Tree>, node_type_t<Tree>>, augment_type_t<Tree>>;
+
+        // The largest gap within a subtree after intervals ending at m. One path down: when m covers the left subtree
+        // its gaps are no larger than the one before the root; otherwise the right subtree sees the same greatest end
+        // as it does within the node, so its gaps are known from right_gap_.
+        template <typename Node, typename T>
+        T gap_after(const std::unique_ptr<Node>& tree, const T& m) {
+            if (!tree) return std::numeric_limits<T>::lowest();
+            auto&& start = start_of(tree->value_);
+            auto covers_left = !tree->left_ || !(m < tree->left_->max_);
+            if (covers_left && !(m < end_of(tree->value_))) return std::max(start - m, gap_after(tree->right_, m));
+            if (covers_left) return std::max(start - m, tree->right_gap_);
+            return std::max({ gap_after(tree->left_, m), start - tree->left_->max_, tree->right_gap_ });
+        }
+
+        // called from update_aggregates for every node whose children are up to date. O(log n), so updates take O(log^2 n)
+        template <typename Node, std::enable_if_t<has_gaps<Node>::value, int> = 0>
+        void update_more_aggregates(std::unique_ptr<Node>& tree) {
+            auto&& end = end_of(tree->value_);
+            tree->right_gap_ = gap_after(tree->right_, tree->left_ ? std::max(tree->left_->max_, end) : end);
+            tree->gap_ = tree->right_gap_;
+            if (tree->left_) tree->gap_ = std::max({ tree->gap_, tree->left_->gap_, start_of(tree->value_) - tree->left_->max_ });
+        }
+
+        // Looks for the first gap of at least length within a subtree after intervals ending at m.
+        // If found, m is where it begins; otherwise m is raised to the greatest end of the subtree.
+        // The left subtree is descended only while m does not cover it and the right one only if right_gap_ allows the gap:
+        // right_gap_ is taken after max(left_->max_, end), which m covers by then, and a greater m only narrows gaps.
+        template <typename Node, typename T>
+        bool first_gap(const std::unique_ptr<Node>& tree, T& m, const T& length) {
+            if (!tree) return false;
+            if (tree->left_ && m < tree->left_->max_) {
+                if (first_gap(tree->left_, m, length)) return true;
+            }
+            // m covers every end before the node now, so the gap before it starts at m
+            if (!(start_of(tree->value_) - m < length)) return true;
+            m = std::max(m, end_of(tree->value_));
+            if (tree->right_gap_ < length) {
+                m = std::max(m, tree->max_);
+                return false;
+            }
+            return first_gap(tree->right_, m, length);
+        }
+
+        template <typename Tree>
+        using enable_gaps_t = std::enable_if_t<std::is_base_of_v<capability_search_interval, Tree> && has_gaps<Tree>::value, int>;
+    }
+
+    // Start of the earliest free slot [x, x + length) with x not before from. The slot begins where the intervals before
+    // it end; past the last interval there is always one. Visits the path down to the gap and, off it, subtrees which
+    // turn out to hold no gap after from, each along a single path of its own: O(log^2 n) at worst, O(log n) in the
+    // common case where from does not fall under long intervals.
+    template <typename T, typename Tree, aux::enable_gaps_t<Tree> = 0>
+    auto find_gap(const Tree& tree, const T& from, const T& length) {
+        using bound_type = typename interval_traits<aux::value_type_t<Tree>>::bound_type;
+        bound_type m = from;
+        aux::first_gap(aux::access(tree), m, static_cast<bound_type>(length));
+        return m;
+    }
+
+    // The largest gap between intervals of a tree in O(1), zero if there are none
+    template <typename Tree, aux::enable_gaps_t<Tree> = 0>
+    auto largest_gap(const Tree& tree) {
+        using bound_type = typename interval_traits<aux::value_type_t<Tree>>::bound_type;
+        auto&& root = aux::access(tree);
+        return root ? std::max(bound_type{}, root->gap_) : bound_type{};
+    }
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "capability_search_interval.hpp"
+#include "tree_interval.hpp"
+#include "type_cti.hpp"
+
+#include <cstddef> // size_t
+#include <future> // std::async
+#include <memory> // std::unique_ptr
+#include <type_traits>
+#include <vector>
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Visits intervals of a tree overlapping q in order
+        template <typename Node, typename Interval, typename F>
+        void overlapping(const std::unique_ptr<Node>& tree, const Interval& q, F& f) {
+            using interval_type = typename Node::value_type;
+            if (!tree || ends_before<interval_type>(tree->max_, start_of(q))) return;
+            overlapping(tree->left_, q, f);
+            if (starts_after<interval_type>(start_of(tree->value_), end_of(q))) return; // the rest starts later still
+            if (!ends_before<interval_type>(end_of(tree->value_), start_of(q))) f(tree->value_);
+            overlapping(tree->right_, q, f);
+        }
+
+        // Visits every overlapping pair of two subtrees. Starts of a subtree are known to be not less than lo (if any):
+        // it is the start of the ancestor the subtree hangs to the right of. Together with max_ it bounds the whole subtree,
+        // so pairs of subtrees far apart are skipped at once. Each pair is found once:
+        // the root of a against all of b, the root of b against the children of a, then the four pairs of children.
+        template <typename NodeA, typename NodeB, typename Bound, typename F>
+        void overlap_join(const std::unique_ptr<NodeA>& a, const Bound* lo_a, const std::unique_ptr<NodeB>& b, const Bound* lo_b, F& f, int forks) {
+            using interval_type = typename NodeA::value_type;
+            if (!a || !b) return;
+            if ((lo_a && starts_after<interval_type>(*lo_a, b->max_)) || (lo_b && starts_after<interval_type>(*lo_b, a->max_))) return;
+
+            auto&& va = a->value_;
+            auto&& vb = b->value_;
+            auto root_a = [&](auto&& y) { f(va, y); };
+            auto root_b = [&](auto&& x) { f(x, vb); };
+            overlapping(b, va, root_a);
+            overlapping(a->left_, vb, root_b);
+            overlapping(a->right_, vb, root_b);
+
+            auto sa = &start_of(va);
+            auto sb = &start_of(vb);
+            if (forks <= 0) {
+                overlap_join(a->left_, lo_a, b->left_, lo_b, f, 0);
+                overlap_join(a->left_, lo_a, b->right_, sb, f, 0);
+                overlap_join(a->right_, sa, b->left_, lo_b, f, 0);
+                overlap_join(a->right_, sa, b->right_, sb, f, 0);
+                return;
+            }
+            std::vector<std::future<void>> tasks; // pairs of children are independent of each other
+            tasks.push_back(std::async(std::launch::async, [&] { overlap_join(a->left_, lo_a, b->right_, sb, f, forks - 1); }));
+            tasks.push_back(std::async(std::launch::async, [&] { overlap_join(a->right_, sa, b->left_, lo_b, f, forks - 1); }));
+            tasks.push_back(std::async(std::launch::async, [&] { overlap_join(a->right_, sa, b->right_, sb, f, forks - 1); }));
+            overlap_join(a->left_, lo_a, b->left_, lo_b, f, forks - 1);
+            for (auto&& t : tasks) t.get();
+        }
+
+        // Enables int type if two interval trees can be joined: bounds must be of the same type and read under the same rules
+        template <typename TreeA, typename TreeB, typename A = value_type_t<TreeA>, typename B = value_type_t<TreeB>>
+        using enable_overlap_join_t =
+            std::enable_if_t< std::is_base_of_v<capability_search_interval, TreeA> && has_interval_aggregates<TreeA>::value
+                            && std::is_base_of_v<capability_search_interval, TreeB> && has_interval_aggregates<TreeB>::value
+                            && std::is_same_v<typename interval_traits<A>::bound_type, typename interval_traits<B>::bound_type>
+                            && interval_traits<A>::half_open == interval_traits<B>::half_open
+            , int>;
+    }
+
+    // Calls f(x, y) for every x of a and y of b which overlap. Both trees are walked at once and pruned by each other's max_,
+    // so it takes far fewer steps than searching b for every element of a. With threads > 1 pairs of subtrees are visited
+    // in parallel and f must be safe to call concurrently; the order of the calls is unspecified then.
+    template <typename TreeA, typename TreeB, typename F, aux::enable_overlap_join_t<TreeA, TreeB> = 0>
+    void overlap_join(const TreeA& a, const TreeB& b, F&& f, size_t threads = 1) {
+        using bound_type = typename interval_traits<aux::value_type_t<TreeA>>::bound_type;
+        int forks = 0; // every fork level multiplies the number of tasks by four
+        for (size_t n = 1; n < threads; n *= 4) ++forks;
+        aux::overlap_join(aux::access(a), static_cast<const bound_type*>(nullptr), aux::access(b), static_cast<const bound_type*>(nullptr), f, forks);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "tree.hpp"
+#include "tree_interval.hpp"
+#include "type_capability.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::find
+#include <type_traits>
+#include <vector>
+
+namespace tree_search {
+
+    // Element of an interval multimap: a single node holds every payload attached to the same bounds.
+    // Only the bounds take part in comparisons, so the tree keeps one node per distinct interval and
+    // overlap queries visit each of them once. Comparisons against interval<T, Payload, HalfOpen> let it be found by one.
+    template <typename T, typename Payload, bool HalfOpen = false>
+    struct interval_bucket {
+        using interval_type = interval<T, Payload, HalfOpen>;
+
+        T                       start_;
+        T                       end_;
+        std::vector<Payload>    payloads_; // in order of insertion
+
+        friend bool operator <(const interval_bucket& l, const interval_bucket& r) { return l.start_ < r.start_ || (!(r.start_ < l.start_) && l.end_ < r.end_); }
+        friend bool operator >(const interval_bucket& l, const interval_bucket& r) { return r < l; }
+        friend bool operator ==(const interval_bucket& l, const interval_bucket& r) { return !(l < r) && !(r < l); }
+
+        friend bool operator <(const interval_type& v, const interval_bucket& r) { return v.start_ < r.start_ || (!(r.start_ < v.start_) && v.end_ < r.end_); }
+        friend bool operator >(const interval_type& v, const interval_bucket& r) { return r.start_ < v.start_ || (!(v.start_ < r.start_) && r.end_ < v.end_); }
+        friend bool operator ==(const interval_type& v, const interval_bucket& r) { return !(v < r) && !(v > r); }
+    };
+
+    template <typename T, typename Payload, bool HalfOpen>
+    struct interval_traits<interval_bucket<T, Payload, HalfOpen>> {
+        using bound_type = T;
+        static constexpr bool half_open = HalfOpen;
+        static const bound_type& start(const interval_bucket<T, Payload, HalfOpen>& v) { return v.start_; }
+        static const bound_type& end(const interval_bucket<T, Payload, HalfOpen>& v) { return v.end_; }
+    };
+
+    // Interval tree where equal intervals may carry many payloads. Search, stab and the counts work on buckets,
+    // i.e. they see every distinct interval once; the payloads are found in payloads_ of the bucket.
+    //     using jobs = tree_search::tree_interval_multimap<int, job_id, true, tree_search::capability_insert_interval,
+    //                                                      tree_search::capability_remove_interval, tree_search::capability_search_interval>;
+    template <typename T, typename Payload, bool HalfOpen, typename ... Capabilities>
+    struct tree_interval_multimap : public tree<interval_bucket<T, Payload, HalfOpen>, interval_augment, Capabilities...> {
+        using interval_type = interval<T, Payload, HalfOpen>;
+        using payload_type = Payload;
+    };
+
+    namespace aux {
+
+        template <typename Tree>
+        struct is_interval_multimap : std::false_type {};
+
+        template <typename T, typename Payload, bool HalfOpen, typename ... Capabilities>
+        struct is_interval_multimap<tree_interval_multimap<T, Payload, HalfOpen, Capabilities...>> : std::true_type {};
+
+        // Enables int type if a single interval with its payload might be put into or taken from a multimap
+        template <typename Interval, typename Tree, typename Capability>
+        using enable_interval_multimap_t =
+            std::enable_if_t< is_interval_multimap<Tree>::value
+                            && std::is_base_of_v<Capability, Tree>
+                            && std::is_same_v<std::decay_t<Interval>, typename Tree::interval_type>
+                            && !std::is_base_of_v<capability_rotate, Tree> // rotation available on a user side may invalidate invariants
+            , int>;
+    }
+
+    // Adds the payload to the bucket of equal bounds. A new bucket goes through the interval tree insert,
+    // while an existing one leaves the tree and its aggregates untouched.
+    template <typename Interval, typename Tree, aux::enable_interval_multimap_t<Interval, Tree, capability_insert_interval> = 0>
+    void insert(Tree& tree, Interval&& v) {
+        if (auto ptr = aux::find(aux::access(tree), v)) {
+            ptr->value_.payloads_.push_back(std::forward<Interval>(v).payload_);
+            return;
+        }
+        using bucket = aux::value_type_t<Tree>;
+        insert(tree, bucket{ v.start_, v.end_, { std::forward<Interval>(v).payload_ } });
+    }
+
+    // Removes one payload equal to the given one. The bucket is removed along with its last payload.
+    template <typename Interval, typename Tree, aux::enable_interval_multimap_t<Interval, Tree, capability_remove_interval> = 0>
+    void remove(Tree& tree, const Interval& v) {
+        auto ptr = aux::find(aux::access(tree), v);
+        if (!ptr) return;
+        auto&& payloads = ptr->value_.payloads_;
+        auto it = std::find(payloads.begin(), payloads.end(), v.payload_);
+        if (it == payloads.end()) return;
+        if (payloads.size() > 1) payloads.erase(it);
+        else remove(tree, aux::value_type_t<Tree>(ptr->value_));
+    }
+}
\ No newline at end of file
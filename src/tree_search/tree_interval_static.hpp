@@ -0,0 +1,169 @@
+#pragma once
+
+#include "capability_search_interval.hpp"
+#include "iterator_aux.hpp"
+#include "tree_interval.hpp"
+#include "type_traverse.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::sort, std::is_sorted, std::partition_point, std::max
+#include <cstddef> // size_t
+#include <iterator> // std::forward_iterator_tag
+#include <memory> // std::unique_ptr
+#include <vector>
+
+namespace tree_search {
+
+    // Read-only interval index over flat arrays, for data loaded once and queried many times.
+    // Intervals are kept sorted and the array is read as an implicit balanced tree: the middle of a range is its root
+    // and max_ at the middle holds the greatest end within the range. There are no pointers to chase,
+    // and a query narrows the array down to intervals starting not later than its end by a binary search.
+    template <typename Interval>
+    struct static_interval_index {
+        using value_type = Interval;
+        using bound_type = typename interval_traits<Interval>::bound_type;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        static_interval_index() = default;
+
+        // Intervals might come in any order; a sorted range is taken as is
+        template <typename It>
+        static_interval_index(It begin, It end) : values_(begin, end) {
+            if (!std::is_sorted(this->values_.begin(), this->values_.end()))
+                std::stable_sort(this->values_.begin(), this->values_.end());
+            this->max_.resize(this->values_.size());
+            if (!this->values_.empty()) this->build(0, this->values_.size());
+            this->ends_.reserve(this->values_.size());
+            for (auto&& v : this->values_) this->ends_.push_back(aux::end_of(v));
+            std::sort(this->ends_.begin(), this->ends_.end());
+        }
+
+        size_t size() const { return this->values_.size(); }
+        bool empty() const { return this->values_.empty(); }
+
+        std::vector<value_type> values_; // sorted as the tree would keep them
+        std::vector<bound_type> max_;    // the greatest end within the implicit subtree rooted at the same position
+        std::vector<bound_type> ends_;   // sorted ends, for counting
+
+    private:
+        const bound_type& build(size_t lo, size_t hi) { // hi > lo
+            auto mid = lo + (hi - lo) / 2;
+            this->max_[mid] = aux::end_of(this->values_[mid]);
+            if (lo < mid) this->max_[mid] = std::max(this->max_[mid], this->build(lo, mid));
+            if (mid + 1 < hi) this->max_[mid] = std::max(this->max_[mid], this->build(mid + 1, hi));
+            return this->max_[mid];
+        }
+    };
+
+    namespace aux {
+
+        // The first position within [from, last) of an interval not ending before a, or npos. The implicit subtree [lo, hi)
+        // is skipped as a whole once its max_ ends before a, so the next match is found in O(log n).
+        template <typename Interval>
+        size_t next_overlap(const static_interval_index<Interval>& index, size_t lo, size_t hi, size_t from, size_t last, const typename static_interval_index<Interval>::bound_type& a) {
+            constexpr auto npos = static_interval_index<Interval>::npos;
+            if (lo >= hi || hi <= from || lo >= last) return npos;
+            auto mid = lo + (hi - lo) / 2;
+            if (ends_before<Interval>(index.max_[mid], a)) return npos;
+            if (from < mid) {
+                auto r = next_overlap(index, lo, mid, from, last, a);
+                if (r != npos) return r;
+            }
+            if (mid >= from && mid < last && !ends_before<Interval>(end_of(index.values_[mid]), a)) return mid;
+            return next_overlap(index, mid + 1, hi, from, last, a);
+        }
+
+        template <typename Node, typename Interval>
+        void collect(const std::unique_ptr<Node>& tree, std::vector<Interval>& out) { // in order
+            if (!tree) return;
+            collect(tree->left_, out);
+            out.push_back(tree->value_);
+            collect(tree->right_, out);
+        }
+    }
+
+    // Forward iterator over intervals of a static index overlapping a query, in order. A default constructed one is the end.
+    template <typename Interval>
+    struct static_interval_iterator {
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Interval;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        using index_type = static_interval_index<Interval>;
+        using bound_type = typename index_type::bound_type;
+
+        static_interval_iterator() = default;
+        static_interval_iterator(const index_type* index, const bound_type& a, const bound_type& b) : index_(index), a_(a) {
+            auto&& values = index->values_;
+            this->last_ = std::partition_point(values.begin(), values.end(), [&](const Interval& v) {
+                return !aux::starts_after<Interval>(aux::start_of(v), b);
+            }) - values.begin();
+            this->seek(0);
+        }
+        static_interval_iterator& operator++() {
+            // neighbours are likely to match as well: a few of them are scanned in place before the implicit tree is descended again
+            auto&& values = this->index_->values_;
+            for (auto i = this->pos_ + 1, stop = std::min(this->last_, i + scan); i < stop; ++i)
+                if (!aux::ends_before<Interval>(aux::end_of(values[i]), this->a_)) {
+                    this->pos_ = i;
+                    return *this;
+                }
+            this->seek(std::min(this->last_, this->pos_ + 1 + scan));
+            return *this;
+        }
+        bool operator==(const static_interval_iterator& other) const {
+            return this->index_ == other.index_ && this->pos_ == other.pos_;
+        }
+        reference operator*() const {
+            return this->index_->values_[this->pos_];
+        }
+    private:
+        static constexpr size_t scan = 8;
+
+        void seek(size_t from) {
+            this->pos_ = aux::next_overlap(*this->index_, 0, this->index_->size(), from, this->last_, this->a_);
+            if (this->pos_ == index_type::npos) this->index_ = nullptr, this->pos_ = 0; // the end
+        }
+
+        const index_type* index_ = nullptr;
+        size_t            pos_ = 0;
+        size_t            last_ = 0; // intervals from here on start after the query
+        bound_type        a_ = {};
+    };
+
+    // Freezes an interval tree into a static index. The tree is traversed in order, so no sorting takes place.
+    template <typename Tree, aux::enable_interval_query_t<Tree> = 0>
+    static_interval_index<aux::value_type_t<Tree>> freeze(const Tree& tree) {
+        std::vector<aux::value_type_t<Tree>> values;
+        values.reserve(aux::access(tree) ? aux::access(tree)->count_ : 0);
+        aux::collect(aux::access(tree), values);
+        return { values.begin(), values.end() };
+    }
+
+    // Same query surface as interval trees have. The index is flat, so intervals come in order only.
+    template <typename Interval, typename Query>
+    iterators<static_interval_iterator<Interval>> search(tag_inorder, const static_interval_index<Interval>& index, const Query& interval) {
+        using bound_type = typename static_interval_index<Interval>::bound_type;
+        bound_type a = aux::start_of(interval);
+        bound_type b = aux::end_of(interval);
+        if (index.empty() || aux::empty_interval<Interval>(a, b)) return {};
+        return { static_interval_iterator<Interval>(&index, a, b), static_interval_iterator<Interval>() };
+    }
+
+    // Every interval starting not later than the end of the query overlaps it unless it ends before the query starts
+    template <typename Interval, typename Query>
+    size_t count_overlaps(const static_interval_index<Interval>& index, const Query& interval) {
+        using bound_type = typename static_interval_index<Interval>::bound_type;
+        bound_type a = aux::start_of(interval);
+        bound_type b = aux::end_of(interval);
+        if (aux::empty_interval<Interval>(a, b)) return 0;
+        auto&& values = index.values_;
+        auto starting = std::partition_point(values.begin(), values.end(), [&](const Interval& v) { return !aux::starts_after<Interval>(aux::start_of(v), b); }) - values.begin();
+        auto ending = std::partition_point(index.ends_.begin(), index.ends_.end(), [&](const bound_type& e) { return aux::ends_before<Interval>(e, a); }) - index.ends_.begin();
+        return static_cast<size_t>(starting - ending);
+    }
+}
\ No newline at end of file
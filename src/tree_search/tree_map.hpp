@@ -0,0 +1,94 @@
+#pragma once
+
+#include "tree.hpp"
+#include "tree_avl.hpp"
+#include "capability_remove.hpp"
+#include "capability_remove_redblack.hpp"
+#include "type_capability.hpp"
+#include "type_cti.hpp"
+
+#include <stdexcept> // std::out_of_range
+#include <type_traits>
+
+namespace tree_search {
+
+    // Element of a map tree: the key and the mapped value are kept apart and only the key takes part in comparisons.
+    // Comparisons against a bare key are provided as well, so lookups and removals do not need a dummy mapped value.
+    template <typename Key, typename Mapped>
+    struct map_entry {
+        using key_type = Key;
+        using mapped_type = Mapped;
+
+        key_type    key_;
+        mapped_type mapped_;
+
+        friend bool operator <(const map_entry& l, const map_entry& r) { return l.key_ < r.key_; }
+        friend bool operator >(const map_entry& l, const map_entry& r) { return r.key_ < l.key_; }
+        friend bool operator ==(const map_entry& l, const map_entry& r) { return l.key_ == r.key_; }
+
+        friend bool operator <(const key_type& k, const map_entry& r) { return k < r.key_; }
+        friend bool operator >(const key_type& k, const map_entry& r) { return r.key_ < k; }
+        friend bool operator ==(const key_type& k, const map_entry& r) { return k == r.key_; }
+    };
+
+    // Map on top of any tree configuration. Rotations and removals relink nodes, so mapped values never move once inserted.
+    //     template <typename K, typename V>
+    //     using map = tree_search::tree_map<K, V, tree_search::avl_augment, tree_search::capability_insert_avl, tree_search::capability_remove_avl>;
+    template <typename Key, typename Mapped, template <typename /*Element*/, typename /*Node*/> typename Augment, typename ... Capabilities>
+    struct tree_map : public tree<map_entry<Key, Mapped>, Augment, Capabilities...> {
+        using key_type = Key;
+        using mapped_type = Mapped;
+
+        // Inserts a default-constructed mapped value if the key is absent. Requires an insert capability.
+        mapped_type& operator[](const key_type& k) {
+            auto ptr = aux::find(aux::access(*this), k);
+            if (!ptr) {
+                insert(*this, map_entry<Key, Mapped>{ k, mapped_type{} }); // goes through the tree's own (possibly balancing) insert
+                ptr = aux::find(aux::access(*this), k);
+            }
+            return ptr->value_.mapped_;
+        }
+
+        mapped_type& at(const key_type& k) {
+            auto ptr = aux::find(aux::access(*this), k);
+            if (!ptr) throw std::out_of_range("tree_map::at: key is absent");
+            return ptr->value_.mapped_;
+        }
+
+        const mapped_type& at(const key_type& k) const {
+            auto ptr = aux::find(aux::access(*this), k);
+            if (!ptr) throw std::out_of_range("tree_map::at: key is absent");
+            return ptr->value_.mapped_;
+        }
+    };
+
+    namespace aux {
+
+        template <typename Tree>
+        struct is_map : std::false_type {};
+
+        template <typename Key, typename Mapped, template <typename, typename> typename Augment, typename ... Capabilities>
+        struct is_map<tree_map<Key, Mapped, Augment, Capabilities...>> : std::true_type {};
+
+        // Enables int type for removal by a bare key.
+        // Plain capability_remove needs nothing extra: its remove does not check the argument type against value_type.
+        template <typename Tree, typename Capability, template <typename, typename> typename Augment>
+        using enable_map_remove_t =
+            std::enable_if_t< is_map<Tree>::value
+                            && std::is_base_of_v<Capability, Tree>
+                            && std::is_same_v<augment_type_t<Tree>, Augment<value_type_t<Tree>, node_type_t<Tree>>>
+                            && !std::is_base_of_v<capability_rotate, Tree> // rotation available on a user side may invalidate invariants
+            , int>;
+    }
+
+    template <typename Tree, aux::enable_map_remove_t<Tree, capability_remove_avl, avl_augment> = 0>
+    void remove(Tree& tree, const typename Tree::key_type& k) {
+        aux::remove(aux::access(tree), k, capability_remove_avl{});
+    }
+
+    template <typename Tree, aux::enable_map_remove_t<Tree, capability_remove_redblack, redblack_augment> = 0>
+    void remove(Tree& tree, const typename Tree::key_type& k) {
+        aux::rbremove(aux::access(tree), k, capability_remove_redblack{});
+        if (aux::access(tree)) aux::access(tree)->color_ = rb_black;
+    }
+}
\ No newline at end of file
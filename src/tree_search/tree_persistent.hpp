@@ -0,0 +1,333 @@
+/* Additional material
+- Driscoll, Sarnak, Sleator, Tarjan. Making Data Structures Persistent https://doi.org/10.1016/0022-0000(89)90034-2
+- Blelloch, Ferizovic, Sun. Just Join for Parallel Ordered Sets https://arxiv.org/abs/1602.02120
+*/
+#pragma once
+
+#include "tree_avl.hpp"
+#include "tree_redblack.hpp"
+#include "type_capability.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::max
+#include <initializer_list>
+#include <memory> // std::shared_ptr
+#include <type_traits>
+#include <utility> // std::forward
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Node of a persistent tree. Once published it is never changed, so any number of trees might share it.
+        template <typename Element, template <typename /*Element*/, typename /*Node*/> typename Augment>
+        struct persistent_node
+            : public Augment<Element, persistent_node<Element, Augment>> {
+            using value_type = Element;
+            using augment_type = Augment<Element, persistent_node>;
+            using node_type = persistent_node;
+            using ptr_type = std::shared_ptr<const node_type>;
+
+            value_type          value_;
+            ptr_type            left_;
+            ptr_type            right_;
+
+            template <typename V = value_type>
+            explicit persistent_node(V&& v) : value_(std::forward<V>(v)) {}
+        };
+    }
+
+    // Tree of shared immutable nodes. A write copies the path it changes and shares the rest with the previous version,
+    // so a copy of the tree is an O(1) snapshot which later writes do not affect. Balanced as an AVL or a red-black tree
+    // depending on the augment; traverse and search capabilities work as for tree.
+    //     using tree = tree_search::persistent_tree<int, tree_search::avl_augment, tree_search::capability_traverse>;
+    template <typename Element, template <typename /*Element*/, typename /*Node*/> typename Augment, typename ... Capabilities>
+    struct persistent_tree : public Capabilities... {
+        using value_type = Element;
+        using node_type = aux::persistent_node<value_type, Augment>;
+        using augment_type = typename node_type::augment_type;
+        using ptr_type = typename node_type::ptr_type;
+
+    private:
+        ptr_type root_; // no direct access. if anything, an access must be performed consiously via aux::access
+
+        template <typename Tree, bool Locked>
+        friend inline auto&& aux::access(Tree&& tree);
+    };
+
+    namespace aux {
+
+        template <typename Node>
+        using shared_node_t = std::shared_ptr<const Node>;
+
+        template <typename Node>
+        struct shared_ranked {
+            shared_node_t<Node> tree_;
+            int                 rank_ = 0;
+        };
+
+        template <typename Node>
+        size_t size(const shared_node_t<Node>& tree) {
+            if (!tree) return 0;
+            return 1 + size(tree->left_) + size(tree->right_);
+        }
+
+        template <typename T, typename Node>
+        const Node* find(const shared_node_t<Node>& tree, const T& v) {
+            auto ptr = tree.get();
+            while (ptr && !(v == ptr->value_))
+                ptr = v < ptr->value_ ? ptr->left_.get() : ptr->right_.get();
+            return ptr;
+        }
+
+        // AVL: the rank is the height. Every rebalancing step builds new nodes instead of rotating old ones.
+        template <typename Node>
+        int rank(const shared_node_t<Node>& tree, capability_remove_avl) {
+            return tree ? tree->height_ : -1;
+        }
+
+        template <typename Node>
+        int child_rank(const Node&, int, const shared_node_t<Node>& child, capability_remove_avl tag) {
+            return rank(child, tag);
+        }
+
+        template <typename Node>
+        shared_node_t<Node> make_node(const shared_node_t<Node>& l, const typename Node::value_type& v, const shared_node_t<Node>& r, capability_remove_avl tag) {
+            auto node = std::make_shared<Node>(v);
+            node->left_ = l;
+            node->right_ = r;
+            node->height_ = 1 + std::max(rank(l, tag), rank(r, tag));
+            return node;
+        }
+
+        template <typename Node>
+        shared_node_t<Node> rotated_left(const shared_node_t<Node>& t, capability_remove_avl tag) {
+            auto&& r = t->right_;
+            return make_node(make_node(t->left_, t->value_, r->left_, tag), r->value_, r->right_, tag);
+        }
+
+        template <typename Node>
+        shared_node_t<Node> rotated_right(const shared_node_t<Node>& t, capability_remove_avl tag) {
+            auto&& l = t->left_;
+            return make_node(l->left_, l->value_, make_node(l->right_, t->value_, t->right_, tag), tag);
+        }
+
+        template <typename Node>
+        shared_node_t<Node> join_right(const shared_node_t<Node>& t, const typename Node::value_type& v, const shared_node_t<Node>& r, capability_remove_avl tag) {
+            auto&& l = t->left_;
+            auto&& c = t->right_;
+            if (rank(c, tag) <= rank(r, tag) + 1) {
+                auto m = make_node(c, v, r, tag);
+                if (rank(m, tag) <= rank(l, tag) + 1) return make_node(l, t->value_, m, tag);
+                return rotated_left(make_node(l, t->value_, rotated_right(m, tag), tag), tag);
+            }
+            auto m = join_right(c, v, r, tag);
+            auto joined = make_node(l, t->value_, m, tag);
+            return rank(m, tag) <= rank(l, tag) + 1 ? joined : rotated_left(joined, tag);
+        }
+
+        template <typename Node>
+        shared_node_t<Node> join_left(const shared_node_t<Node>& l, const typename Node::value_type& v, const shared_node_t<Node>& t, capability_remove_avl tag) { // mirrors join_right
+            auto&& r = t->right_;
+            auto&& c = t->left_;
+            if (rank(c, tag) <= rank(l, tag) + 1) {
+                auto m = make_node(l, v, c, tag);
+                if (rank(m, tag) <= rank(r, tag) + 1) return make_node(m, t->value_, r, tag);
+                return rotated_right(make_node(rotated_left(m, tag), t->value_, r, tag), tag);
+            }
+            auto m = join_left(l, v, c, tag);
+            auto joined = make_node(m, t->value_, r, tag);
+            return rank(m, tag) <= rank(r, tag) + 1 ? joined : rotated_right(joined, tag);
+        }
+
+        template <typename Node>
+        shared_ranked<Node> join(const shared_node_t<Node>& l, int rl, const typename Node::value_type& v, const shared_node_t<Node>& r, int rr, capability_remove_avl tag) {
+            auto t = rl > rr + 1 ? join_right(l, v, r, tag)
+                   : rr > rl + 1 ? join_left(l, v, r, tag)
+                   : make_node(l, v, r, tag);
+            auto rank_t = rank(t, tag);
+            return { std::move(t), rank_t };
+        }
+
+        // Red-black: the rank is the black height. Colors are fixed on new nodes only.
+        template <typename Node>
+        int rank(const shared_node_t<Node>& tree, capability_remove_redblack) { // O(log n)
+            int r = 0;
+            for (auto p = tree.get(); p; p = p->left_.get())
+                if (p->color_ == rb_black) ++r;
+            return r;
+        }
+
+        template <typename Node>
+        int child_rank(const Node& parent, int parent_rank, const shared_node_t<Node>&, capability_remove_redblack) {
+            return parent_rank - (parent.color_ == rb_black ? 1 : 0);
+        }
+
+        template <typename Node>
+        rb_color color_of(const shared_node_t<Node>& t) {
+            return t ? t->color_ : rb_black;
+        }
+
+        template <typename Node>
+        shared_node_t<Node> make_node(const shared_node_t<Node>& l, const typename Node::value_type& v, const shared_node_t<Node>& r, rb_color color) {
+            auto node = std::make_shared<Node>(v);
+            node->left_ = l;
+            node->right_ = r;
+            node->color_ = color;
+            return node;
+        }
+
+        template <typename Node>
+        shared_node_t<Node> blackened(const shared_node_t<Node>& t) {
+            return t->color_ == rb_black ? t : make_node(t->left_, t->value_, t->right_, rb_black);
+        }
+
+        template <typename Node>
+        shared_node_t<Node> join_right(const shared_node_t<Node>& t, int rt, const typename Node::value_type& v, const shared_node_t<Node>& r, int rr) {
+            if (rt == rr && color_of(t) == rb_black) return make_node(t, v, r, rb_red);
+            auto m = join_right(t->right_, rt - (t->color_ == rb_black ? 1 : 0), v, r, rr);
+            if (t->color_ == rb_black && color_of(m) == rb_red && color_of(m->right_) == rb_red) { // rotates left, the lower red goes black
+                auto l = make_node(t->left_, t->value_, m->left_, rb_black);
+                return make_node(l, m->value_, blackened(m->right_), rb_red);
+            }
+            return make_node(t->left_, t->value_, m, t->color_);
+        }
+
+        template <typename Node>
+        shared_node_t<Node> join_left(const shared_node_t<Node>& l, int rl, const typename Node::value_type& v, const shared_node_t<Node>& t, int rt) { // mirrors join_right
+            if (rt == rl && color_of(t) == rb_black) return make_node(l, v, t, rb_red);
+            auto m = join_left(l, rl, v, t->left_, rt - (t->color_ == rb_black ? 1 : 0));
+            if (t->color_ == rb_black && color_of(m) == rb_red && color_of(m->left_) == rb_red) {
+                auto r = make_node(m->right_, t->value_, t->right_, rb_black);
+                return make_node(blackened(m->left_), m->value_, r, rb_red);
+            }
+            return make_node(m, t->value_, t->right_, t->color_);
+        }
+
+        template <typename Node>
+        shared_ranked<Node> join(shared_node_t<Node> l, int rl, const typename Node::value_type& v, shared_node_t<Node> r, int rr, capability_remove_redblack) {
+            // a red root might be a subtree cut off from a bigger tree. repainting it black keeps it a valid rb-tree
+            if (color_of(l) == rb_red) l = blackened(l), ++rl;
+            if (color_of(r) == rb_red) r = blackened(r), ++rr;
+            if (rl == rr) return { make_node(l, v, r, rb_black), rl + 1 };
+            auto t = rl > rr ? join_right(l, rl, v, r, rr) : join_left(l, rl, v, r, rr);
+            auto rank_t = std::max(rl, rr);
+            if (t->color_ == rb_red) t = blackened(t), ++rank_t;
+            return { std::move(t), rank_t };
+        }
+
+        // Detaches the minimum: the rest of the tree comes back rebuilt by joins, the minimum is copied into min
+        template <typename Node, typename Tag>
+        shared_ranked<Node> without_min(const shared_node_t<Node>& tree, int tree_rank, typename Node::value_type& min, Tag tag) {
+            auto rr = child_rank(*tree, tree_rank, tree->right_, tag);
+            if (!tree->left_) {
+                min = tree->value_;
+                return { tree->right_, rr };
+            }
+            auto l = without_min(tree->left_, child_rank(*tree, tree_rank, tree->left_, tag), min, tag);
+            return join(l.tree_, l.rank_, tree->value_, tree->right_, rr, tag);
+        }
+
+        template <typename Node, typename Tag>
+        shared_ranked<Node> join(const shared_ranked<Node>& l, const shared_ranked<Node>& r, Tag tag) { // l < r, without a middle element
+            if (!r.tree_) return l;
+            if (!l.tree_) return r;
+            auto min = r.tree_->value_;
+            auto rest = without_min(r.tree_, r.rank_, min, tag);
+            return join(l.tree_, l.rank_, min, rest.tree_, rest.rank_, tag);
+        }
+
+        template <typename Node>
+        struct shared_split {
+            shared_ranked<Node> less_;
+            bool                found_ = false;
+            shared_ranked<Node> greater_;
+        };
+
+        // Splits a tree into elements less than v and greater than v. Only the nodes along the path of v are copied.
+        template <typename Node, typename T, typename Tag>
+        shared_split<Node> split3(const shared_node_t<Node>& tree, int tree_rank, const T& v, Tag tag) {
+            if (!tree) return { shared_ranked<Node>{ nullptr, tree_rank }, false, shared_ranked<Node>{ nullptr, tree_rank } };
+            auto rl = child_rank(*tree, tree_rank, tree->left_, tag);
+            auto rr = child_rank(*tree, tree_rank, tree->right_, tag);
+            if (v < tree->value_) {
+                auto s = split3(tree->left_, rl, v, tag);
+                s.greater_ = join(s.greater_.tree_, s.greater_.rank_, tree->value_, tree->right_, rr, tag);
+                return s;
+            }
+            if (tree->value_ < v) {
+                auto s = split3(tree->right_, rr, v, tag);
+                s.less_ = join(tree->left_, rl, tree->value_, s.less_.tree_, s.less_.rank_, tag);
+                return s;
+            }
+            return { shared_ranked<Node>{ tree->left_, rl }, true, shared_ranked<Node>{ tree->right_, rr } };
+        }
+
+        // A subtree cut off from a bigger tree might have a red root. Makes it a proper tree on its own.
+        template <typename Node>
+        void blacken_root(shared_node_t<Node>&, capability_remove_avl) {}
+
+        template <typename Node>
+        void blacken_root(shared_node_t<Node>& tree, capability_remove_redblack) {
+            if (tree) tree = blackened(tree);
+        }
+
+        template <typename Tree>
+        struct is_persistent : std::false_type {};
+
+        template <typename Element, template <typename, typename> typename Augment, typename ... Capabilities>
+        struct is_persistent<persistent_tree<Element, Augment, Capabilities...>> : std::true_type {};
+
+        // Picks how a persistent tree is balanced by its augment
+        template <typename Tree>
+        using persistent_tag_t =
+            std::conditional_t<std::is_base_of_v<redblack_augment<value_type_t<Tree>, node_type_t<Tree>>, augment_type_t<Tree>>, capability_remove_redblack,
+            std::conditional_t<std::is_base_of_v<avl_augment<value_type_t<Tree>, node_type_t<Tree>>, augment_type_t<Tree>>, capability_remove_avl, void>>;
+
+        // Enables int type for persistent trees balanced as AVL or red-black ones
+        template <typename Tree>
+        using enable_persistent_t = std::enable_if_t<is_persistent<Tree>::value && !std::is_void_v<persistent_tag_t<Tree>>, int>;
+    }
+
+    // O(log n) new nodes; the previous version of the tree is left as it was
+    template <typename T, typename Tree, aux::enable_persistent_t<Tree> = 0>
+    void insert(Tree& tree, T&& v) {
+        auto&& root = aux::access(tree);
+        if (aux::find(root, v)) return;
+        auto tag = aux::persistent_tag_t<Tree>{};
+        auto s = aux::split3(root, aux::rank(root, tag), v, tag);
+        root = aux::join(s.less_.tree_, s.less_.rank_, aux::value_type_t<Tree>(std::forward<T>(v)), s.greater_.tree_, s.greater_.rank_, tag).tree_;
+    }
+
+    template <typename T, typename Tree, aux::enable_persistent_t<Tree> = 0>
+    void insert(Tree& tree, std::initializer_list<T> ls) {
+        for (auto&& v : ls) insert(tree, v);
+    }
+
+    // O(log n) new nodes; the previous version of the tree is left as it was
+    template <typename T, typename Tree, aux::enable_persistent_t<Tree> = 0>
+    void remove(Tree& tree, const T& v) {
+        auto&& root = aux::access(tree);
+        if (!aux::find(root, v)) return;
+        auto tag = aux::persistent_tag_t<Tree>{};
+        auto s = aux::split3(root, aux::rank(root, tag), v, tag);
+        root = aux::join(s.less_, s.greater_, tag).tree_;
+        aux::blacken_root(root, tag);
+    }
+
+    template <typename T, typename Tree, aux::enable_persistent_t<Tree> = 0>
+    void remove(Tree& tree, std::initializer_list<T> ls) {
+        for (auto&& v : ls) remove(tree, v);
+    }
+
+    // The version of the tree as it is now, in O(1). It shares all nodes with the tree, and neither sees later writes of the other.
+    template <typename Tree, aux::enable_persistent_t<Tree> = 0>
+    Tree snapshot(const Tree& tree) {
+        return tree;
+    }
+
+    template <typename Element, template <typename, typename> typename Augment, typename ... Capabilities>
+    size_t size(const persistent_tree<Element, Augment, Capabilities...>& tree) {
+        return aux::size(aux::access(tree));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+/* Additional material
+- McKenney, Slingwine. Read-Copy Update: Using Execution History to Solve Concurrency Problems
+- Fraser. Practical lock-freedom, ch. 5.2.3 epoch-based reclamation https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf
+*/
+#pragma once
+
+#include "tree_persistent.hpp"
+
+#include <atomic>
+#include <cstdint> // uint64_t
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <stdexcept> // std::length_error
+#include <utility> // std::forward
+#include <vector>
+
+namespace tree_search {
+
+    // Publishes versions of a persistent tree to readers which neither lock nor write to shared memory.
+    // A writer changes a copy of the current version (O(1) to take, O(log n) nodes to change) and swaps it in.
+    // Versions replaced are freed once no reader that might have seen them is reading any more (epoch-based reclamation).
+    // Writers are serialized among themselves.
+    template <typename Tree>
+    struct rcu_tree {
+        static_assert(aux::is_persistent<Tree>::value, "rcu_tree publishes versions of a persistent_tree only");
+        using tree_type = Tree;
+
+        explicit rcu_tree(size_t readers = 64) : slots_(new slot[readers]), readers_(readers), current_(new Tree()) {}
+        rcu_tree(const rcu_tree&) = delete;
+        rcu_tree& operator=(const rcu_tree&) = delete;
+        ~rcu_tree() { // no reader must be left
+            delete this->current_.load();
+            for (auto&& r : this->retired_) delete r.first;
+        }
+
+        struct alignas(64) slot { // one per reader, on a cache line of its own
+            std::atomic<uint64_t> epoch_{ 0 }; // epoch the reader entered at, 0 if it is not reading
+            std::atomic<bool>     taken_{ false };
+        };
+
+        std::unique_ptr<slot[]>             slots_;
+        size_t                              readers_;
+        std::atomic<const Tree*>            current_;
+        std::atomic<uint64_t>               epoch_{ 1 };
+        std::mutex                          writer_;
+        std::vector<std::pair<const Tree*, uint64_t>> retired_; // versions replaced, with the epoch they were replaced in
+    };
+
+    // Reading side of an rcu_tree for one thread. Takes a reader slot for its lifetime.
+    // Read sections through it might be nested; the slot is left when the outermost one ends.
+    template <typename Tree>
+    struct rcu_reader {
+        explicit rcu_reader(rcu_tree<Tree>& rcu) : rcu_(rcu) {
+            for (size_t i = 0; i != rcu.readers_; ++i) {
+                auto free = false;
+                if (rcu.slots_[i].taken_.compare_exchange_strong(free, true)) {
+                    this->slot_ = &rcu.slots_[i];
+                    return;
+                }
+            }
+            throw std::length_error("rcu_tree: no reader slot left");
+        }
+        rcu_reader(const rcu_reader&) = delete;
+        rcu_reader& operator=(const rcu_reader&) = delete;
+        ~rcu_reader() { this->slot_->taken_.store(false); }
+
+        rcu_tree<Tree>&                rcu_;
+        typename rcu_tree<Tree>::slot* slot_ = nullptr;
+        size_t                         depth_ = 0; // read sections entered and not left yet. its own thread only touches it
+    };
+
+    namespace aux {
+
+        // Frees versions no reader might still see: those replaced before the earliest epoch any reader has entered at
+        template <typename Tree>
+        void reclaim(rcu_tree<Tree>& rcu) {
+            auto oldest = rcu.epoch_.load();
+            for (size_t i = 0; i != rcu.readers_; ++i) {
+                auto e = rcu.slots_[i].epoch_.load();
+                if (e != 0 && e < oldest) oldest = e;
+            }
+            auto&& retired = rcu.retired_;
+            auto kept = retired.begin();
+            for (auto&& r : retired) {
+                if (r.second < oldest) delete r.first;
+                else *kept++ = r;
+            }
+            retired.erase(kept, retired.end());
+        }
+    }
+
+    // Runs f(tree) on the current version. Readers store to their own slot only: no locks and no read-modify-writes.
+    // Nothing obtained from the tree (iterators, references) must leave f.
+    // A read nested in another one keeps the epoch of the outer one, which protects the versions of both.
+    template <typename Tree, typename F>
+    decltype(auto) read(rcu_reader<Tree>& reader, F&& f) {
+        struct leave {
+            rcu_reader<Tree>& reader_;
+            ~leave() { if (--this->reader_.depth_ == 0) this->reader_.slot_->epoch_.store(0, std::memory_order_release); }
+        };
+        auto&& rcu = reader.rcu_;
+        if (reader.depth_ == 0) {
+            reader.slot_->epoch_.store(rcu.epoch_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst); // the epoch is visible to writers before the version is read
+        }
+        ++reader.depth_;
+        leave guard{ reader };
+        return std::forward<F>(f)(*rcu.current_.load(std::memory_order_acquire));
+    }
+
+    // Runs f(tree) on a copy of the current version and publishes it. Readers see either the old version or the new one.
+    template <typename Tree, typename F>
+    void write(rcu_tree<Tree>& rcu, F&& f) {
+        std::lock_guard<std::mutex> lock(rcu.writer_);
+        auto old = rcu.current_.load(std::memory_order_relaxed);
+        auto next = std::make_unique<Tree>(*old);
+        std::forward<F>(f)(*next);
+        rcu.current_.store(next.release());
+        rcu.retired_.emplace_back(old, rcu.epoch_.fetch_add(1));
+        aux::reclaim(rcu);
+    }
+
+    // Number of replaced versions not freed yet
+    template <typename Tree>
+    size_t pending(rcu_tree<Tree>& rcu) {
+        std::lock_guard<std::mutex> lock(rcu.writer_);
+        return rcu.retired_.size();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+/* Additional material
+- Blelloch, Ferizovic, Sun. Just Join for Parallel Ordered Sets https://arxiv.org/abs/1602.02120
+*/
+#pragma once
+
+#include "tree_split_join.hpp"
+#include "type_capability.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::max
+#include <future> // std::async
+#include <limits>
+#include <memory> // std::unique_ptr
+#include <thread> // std::thread::hardware_concurrency
+#include <utility> // std::pair
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Smallest rank of a subtree worth a task of its own. Below it a fork costs more than the work it saves.
+        inline int parallel_rank(capability_remove) { return std::numeric_limits<int>::max(); } // plain trees are not balanced; subtrees say nothing about their size
+        inline int parallel_rank(capability_remove_avl) { return 12; }
+        inline int parallel_rank(capability_remove_redblack) { return 6; }
+        inline int parallel_rank(capability_remove_interval) { return 6; }
+
+        // Number of nested forks: every level doubles the number of tasks, one level more than the cores for load balancing
+        inline int fork_depth() {
+            int depth = 1;
+            for (auto n = std::thread::hardware_concurrency(); n > 1; n >>= 1) ++depth;
+            return depth;
+        }
+
+        // Runs both calls, the second one asynchronously if it is worth it. std::async is backed by a thread pool on MSVC.
+        template <typename F, typename G>
+        auto fork_join(bool parallel, F&& f, G&& g) {
+            if (!parallel) {
+                auto l = f();
+                return std::make_pair(std::move(l), g());
+            }
+            auto r = std::async(std::launch::async, std::forward<G>(g));
+            auto l = f();
+            return std::make_pair(std::move(l), r.get());
+        }
+
+        template <typename Node, typename Tag>
+        ranked<Node> empty(Tag tag) {
+            return { nullptr, rank(std::unique_ptr<Node>{}, tag) };
+        }
+
+        // Elements of both trees. If an element is in both, the one of 'a' is kept.
+        template <typename Node, typename Tag>
+        ranked<Node> union_of(ranked<Node> a, ranked<Node> b, int forks, Tag tag) {
+            if (!a.tree_) return b;
+            if (!b.tree_) return a;
+            auto parallel = forks > 0 && std::max(a.rank_, b.rank_) >= parallel_rank(tag);
+            auto rl = child_rank(*a.tree_, a.rank_, a.tree_->left_, tag);
+            auto rr = child_rank(*a.tree_, a.rank_, a.tree_->right_, tag);
+            auto m = std::move(a.tree_);
+            auto s = split3(std::move(b.tree_), b.rank_, m->value_, tag); // s.equal_ is released
+            auto lr = fork_join(parallel,
+                [&] { return union_of(ranked<Node>{ std::move(m->left_), rl }, std::move(s.less_), forks - 1, tag); },
+                [&] { return union_of(ranked<Node>{ std::move(m->right_), rr }, std::move(s.greater_), forks - 1, tag); });
+            return join(std::move(lr.first.tree_), lr.first.rank_, std::move(m), std::move(lr.second.tree_), lr.second.rank_, tag);
+        }
+
+        // Elements of 'a' that are in 'b' as well
+        template <typename Node, typename Tag>
+        ranked<Node> intersection_of(ranked<Node> a, ranked<Node> b, int forks, Tag tag) {
+            if (!a.tree_ || !b.tree_) return empty<Node>(tag);
+            auto parallel = forks > 0 && std::max(a.rank_, b.rank_) >= parallel_rank(tag);
+            auto rl = child_rank(*a.tree_, a.rank_, a.tree_->left_, tag);
+            auto rr = child_rank(*a.tree_, a.rank_, a.tree_->right_, tag);
+            auto m = std::move(a.tree_);
+            auto s = split3(std::move(b.tree_), b.rank_, m->value_, tag);
+            auto lr = fork_join(parallel,
+                [&] { return intersection_of(ranked<Node>{ std::move(m->left_), rl }, std::move(s.less_), forks - 1, tag); },
+                [&] { return intersection_of(ranked<Node>{ std::move(m->right_), rr }, std::move(s.greater_), forks - 1, tag); });
+            if (s.equal_)
+                return join(std::move(lr.first.tree_), lr.first.rank_, std::move(m), std::move(lr.second.tree_), lr.second.rank_, tag);
+            return join(std::move(lr.first), std::move(lr.second), tag);
+        }
+
+        // Elements of 'a' that are not in 'b'
+        template <typename Node, typename Tag>
+        ranked<Node> difference_of(ranked<Node> a, ranked<Node> b, int forks, Tag tag) {
+            if (!a.tree_ || !b.tree_) return a;
+            auto parallel = forks > 0 && std::max(a.rank_, b.rank_) >= parallel_rank(tag);
+            auto rl = child_rank(*b.tree_, b.rank_, b.tree_->left_, tag);
+            auto rr = child_rank(*b.tree_, b.rank_, b.tree_->right_, tag);
+            auto m = std::move(b.tree_);
+            auto s = split3(std::move(a.tree_), a.rank_, m->value_, tag); // s.equal_ is released
+            auto lr = fork_join(parallel,
+                [&] { return difference_of(std::move(s.less_), ranked<Node>{ std::move(m->left_), rl }, forks - 1, tag); },
+                [&] { return difference_of(std::move(s.greater_), ranked<Node>{ std::move(m->right_), rr }, forks - 1, tag); });
+            return join(std::move(lr.first), std::move(lr.second), tag);
+        }
+
+        template <typename Tree, typename F>
+        Tree set_operation(Tree& a, Tree& b, F f) {
+            using ranked = aux::ranked<aux::node_type_t<Tree>>;
+            auto tag = split_tag_t<Tree>{};
+            auto ra = rank(access(a), tag);
+            auto rb = rank(access(b), tag);
+            Tree res;
+            access(res) = f(ranked{ std::move(access(a)), ra }, ranked{ std::move(access(b)), rb }, fork_depth(), tag).tree_;
+            blacken_root(access(res), tag);
+            if constexpr (is_counted<Tree>::value) res.ends_ = set_operation(a.ends_, b.ends_, f); // an end key stands for one interval, so the indexes go the same way
+            return res;
+        }
+    }
+
+    // Set operations built on split and join. They take O(m log(n/m + 1)) work for trees of sizes m <= n,
+    // and independent subtrees are processed in parallel. Nodes are moved, so both trees are left empty.
+
+    template <typename Tree, aux::enable_split_join_t<Tree> = 0>
+    Tree union_of(Tree& a, Tree& b) { // if an element is in both trees, the one of 'a' is kept
+        return aux::set_operation(a, b, [](auto&& ... args) { return aux::union_of(std::move(args)...); });
+    }
+
+    template <typename Tree, aux::enable_split_join_t<Tree> = 0>
+    Tree intersection_of(Tree& a, Tree& b) { // elements are taken from 'a'
+        return aux::set_operation(a, b, [](auto&& ... args) { return aux::intersection_of(std::move(args)...); });
+    }
+
+    template <typename Tree, aux::enable_split_join_t<Tree> = 0>
+    Tree difference_of(Tree& a, Tree& b) { // elements of 'a' which are not in 'b'
+        return aux::set_operation(a, b, [](auto&& ... args) { return aux::difference_of(std::move(args)...); });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "iterator_aux.hpp"
+#include "tree_split_join.hpp"
+
+#include <algorithm> // std::upper_bound
+#include <cstddef> // size_t
+#include <initializer_list>
+#include <iterator> // std::forward_iterator_tag
+#include <memory> // std::unique_ptr
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility> // std::forward, std::move
+#include <vector>
+
+namespace tree_search {
+
+    // Splits the key space into ranges, each kept by a tree of its own behind a lock of its own, so writers to
+    // different ranges do not wait for each other. Shard i holds elements within [bounds_[i - 1], bounds_[i]).
+    // insert, remove, search and traverse work as for the tree; in order traversal runs across shards in key order.
+    //     using tree = tree_search::tree<int, tree_search::avl_augment, tree_search::capability_insert_avl, tree_search::capability_remove_avl, ...>;
+    //     tree_search::sharded_tree<tree> shards({ 1000, 2000, 3000 }); // four shards
+    template <typename Tree>
+    struct sharded_tree {
+        using tree_type = Tree;
+        using value_type = aux::value_type_t<Tree>;
+        using node_type = aux::node_type_t<Tree>;
+
+        struct shard {
+            mutable std::shared_mutex mutex_;
+            Tree                      tree_;
+            size_t                    writes_ = 0; // since the last reshard
+        };
+
+        sharded_tree() : sharded_tree(std::vector<value_type>{}) {}
+        explicit sharded_tree(std::vector<value_type> bounds) : bounds_(std::move(bounds)) { // bounds must be sorted
+            for (size_t i = 0; i <= this->bounds_.size(); ++i) this->shards_.emplace_back(new shard());
+        }
+
+        size_t shard_of(const value_type& v) const {
+            return std::upper_bound(this->bounds_.begin(), this->bounds_.end(), v) - this->bounds_.begin();
+        }
+
+        mutable std::shared_mutex           layout_; // taken exclusively only to change bounds_ and shards_
+        std::vector<value_type>             bounds_;
+        std::vector<std::unique_ptr<shard>> shards_;
+    };
+
+    // Forward iterator running over ranges of several shards one after another
+    template <typename It>
+    struct sharded_iterator {
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename It::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename It::pointer;
+        using reference = typename It::reference;
+
+        sharded_iterator() = default;
+        sharded_iterator(const iterators<It>* parts, size_t part, size_t count) : parts_(parts), part_(part), count_(count) {
+            if (this->part_ != this->count_) this->it_ = begin(this->parts_[this->part_]);
+            this->skip_empty();
+        }
+        sharded_iterator& operator++() {
+            ++this->it_;
+            this->skip_empty();
+            return *this;
+        }
+        bool operator==(const sharded_iterator& other) const {
+            return this->part_ == other.part_ && (this->part_ == this->count_ || this->it_ == other.it_);
+        }
+        reference operator*() const {
+            return *this->it_;
+        }
+    private:
+        void skip_empty() {
+            while (this->part_ != this->count_ && !(this->it_ != end(this->parts_[this->part_])))
+                if (++this->part_ != this->count_) this->it_ = begin(this->parts_[this->part_]);
+        }
+
+        const iterators<It>* parts_ = nullptr;
+        size_t               part_ = 0;
+        size_t               count_ = 0;
+        It                   it_ = {};
+    };
+
+    // Range over all shards. It holds read access to every shard for as long as it lives, so it sees one consistent state.
+    template <typename It>
+    struct sharded_iterators
+        : public iterators<sharded_iterator<It>> {
+
+        template <typename Tree, typename F>
+        sharded_iterators(const sharded_tree<Tree>& tree, F&& f) : layout_(tree.layout_) {
+            for (auto&& s : tree.shards_) {
+                this->locks_.emplace_back(s->mutex_);
+                this->parts_.push_back(f(s->tree_));
+            }
+            // the parts do not move from now on, even if the range does
+            this->begin_ = sharded_iterator<It>(this->parts_.data(), 0, this->parts_.size());
+            this->end_ = sharded_iterator<It>(this->parts_.data(), this->parts_.size(), this->parts_.size());
+        }
+    private:
+        std::shared_lock<std::shared_mutex>              layout_;
+        std::vector<std::shared_lock<std::shared_mutex>> locks_;
+        std::vector<iterators<It>>                       parts_;
+    };
+
+    namespace aux {
+
+        template <typename Tree>
+        struct is_sharded : std::false_type {};
+
+        template <typename Tree>
+        struct is_sharded<sharded_tree<Tree>> : std::true_type {};
+
+        template <typename Tree>
+        using enable_sharded_t = std::enable_if_t<is_sharded<std::decay_t<Tree>>::value, int>;
+
+        // Runs f on the tree of the shard v belongs to, with the shard locked exclusively
+        template <typename Tree, typename T, typename F>
+        void write_shard(sharded_tree<Tree>& tree, const T& v, F&& f) {
+            std::shared_lock<std::shared_mutex> layout(tree.layout_);
+            auto&& s = *tree.shards_[tree.shard_of(v)];
+            std::unique_lock<std::shared_mutex> lock(s.mutex_);
+            f(s.tree_);
+            ++s.writes_;
+        }
+    }
+
+    template <typename T, typename Tree, aux::enable_sharded_t<Tree> = 0>
+    void insert(Tree& tree, T&& v) {
+        aux::value_type_t<Tree> value(std::forward<T>(v));
+        aux::write_shard(tree, value, [&](auto& t) { insert(t, std::move(value)); });
+    }
+
+    template <typename T, typename Tree, aux::enable_sharded_t<Tree> = 0>
+    void insert(Tree& tree, std::initializer_list<T> ls) {
+        for (auto&& v : ls) insert(tree, v);
+    }
+
+    template <typename T, typename Tree, aux::enable_sharded_t<Tree> = 0>
+    void remove(Tree& tree, const T& v) {
+        aux::write_shard(tree, v, [&](auto& t) { remove(t, v); });
+    }
+
+    template <typename T, typename Tree, aux::enable_sharded_t<Tree> = 0>
+    void remove(Tree& tree, std::initializer_list<T> ls) {
+        for (auto&& v : ls) remove(tree, v);
+    }
+
+    // Same as search on every shard, one shard after another
+    template <typename Tag, typename Tree, typename ... Args, aux::enable_sharded_t<Tree> = 0>
+    auto search(Tag&&, const Tree& tree, Args&&... args) {
+        using tag_type = std::decay_t<Tag>;
+        using range_type = decltype(search(tag_type{}, std::declval<const typename Tree::tree_type&>(), args...));
+        return sharded_iterators<decltype(range_type{}.begin_)>(tree, [&](auto& t) { return search(tag_type{}, t, args...); });
+    }
+
+    // Same as traverse on every shard, one shard after another. In order it is the order of the whole key space.
+    template <typename Tag, typename Tree, aux::enable_sharded_t<Tree> = 0>
+    auto traverse(Tag&&, const Tree& tree) {
+        using tag_type = std::decay_t<Tag>;
+        using range_type = decltype(traverse(tag_type{}, std::declval<const typename Tree::tree_type&>()));
+        return sharded_iterators<decltype(range_type{}.begin_)>(tree, [](auto& t) { return traverse(tag_type{}, t); });
+    }
+
+    template <typename Tree, aux::enable_sharded_t<Tree> = 0>
+    size_t size(const Tree& tree) {
+        std::shared_lock<std::shared_mutex> layout(tree.layout_);
+        size_t n = 0;
+        for (auto&& s : tree.shards_) {
+            std::shared_lock<std::shared_mutex> lock(s->mutex_);
+            n += size(s->tree_);
+        }
+        return n;
+    }
+
+    // Splits every shard which took more than max_writes writes since the last call, in O(log n) per split.
+    // A shard is split at the element of its root rather than at its median: the root is at hand, and in a balanced tree
+    // both of its subtrees are of logarithmic height, though not of equal size.
+    // Everything waits for it, so it is meant to run now and then. Returns the number of shards split.
+    template <typename Tree, aux::enable_sharded_t<Tree> = 0, aux::enable_split_join_t<typename Tree::tree_type> = 0>
+    size_t reshard(Tree& tree, size_t max_writes) {
+        using shard = typename Tree::shard;
+        std::unique_lock<std::shared_mutex> layout(tree.layout_);
+        size_t splits = 0;
+        for (size_t i = 0; i != tree.shards_.size(); ++i) {
+            auto&& s = *tree.shards_[i];
+            auto hot = s.writes_ > max_writes;
+            s.writes_ = 0;
+            if (!hot) continue;
+            auto root = aux::access(s.tree_).get();
+            if (!root || (!root->left_ && !root->right_)) continue;
+            auto bound = root->left_ ? root->value_ : root->right_->value_; // the lower part gets [.., bound)
+            auto parts = split(s.tree_, bound);
+            std::unique_ptr<shard> upper(new shard());
+            s.tree_ = std::move(parts.first);
+            upper->tree_ = std::move(parts.second);
+            tree.bounds_.insert(tree.bounds_.begin() + i, bound);
+            tree.shards_.insert(tree.shards_.begin() + i + 1, std::move(upper));
+            ++splits;
+            ++i; // the upper half is not split again right away
+        }
+        return splits;
+    }
+}
\ No newline at end of file
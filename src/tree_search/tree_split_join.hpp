@@ -0,0 +1,335 @@
+/* Additional material
+- Blelloch, Ferizovic, Sun. Just Join for Parallel Ordered Sets https://arxiv.org/abs/1602.02120
+- https://en.wikipedia.org/wiki/Join-based_tree_algorithms
+*/
+#pragma once
+
+#include "capability_insert.hpp"
+#include "capability_remove.hpp"
+#include "tree_avl.hpp"
+#include "tree_redblack.hpp"
+#include "capability_insert_redblack.hpp"
+#include "capability_remove_redblack.hpp"
+#include "tree_interval.hpp"
+#include "type_capability.hpp"
+#include "type_cti.hpp"
+
+#include <memory> // std::unique_ptr
+#include <type_traits>
+#include <utility> // std::pair
+
+namespace tree_search {
+
+    namespace aux {
+
+        // Join balances trees by their rank: height for AVL trees, black height for red-black ones (sentinels excluded).
+        // Plain trees are not balanced, so their rank is always 0.
+        template <typename Node>
+        struct ranked {
+            std::unique_ptr<Node> tree_;
+            int                   rank_ = 0;
+        };
+
+        template <typename Node>
+        int rank(const std::unique_ptr<Node>&, capability_remove) {
+            return 0;
+        }
+
+        template <typename Node>
+        int rank(const std::unique_ptr<Node>& tree, capability_remove_avl) {
+            return tree ? tree->height_ : -1;
+        }
+
+        template <typename Node, typename Tag, std::enable_if_t<is_one_of_v<Tag, capability_remove_redblack, capability_remove_interval>, int> = 0>
+        int rank(const std::unique_ptr<Node>& tree, Tag) { // O(log n)
+            int r = 0;
+            for (auto p = tree.get(); p; p = p->left_.get())
+                if (p->color_ == rb_black) ++r;
+            return r;
+        }
+
+        // Rank of a child derived from the parent's rank in O(1)
+        template <typename Node>
+        int child_rank(const Node&, int, const std::unique_ptr<Node>&, capability_remove) {
+            return 0;
+        }
+
+        template <typename Node>
+        int child_rank(const Node&, int, const std::unique_ptr<Node>& child, capability_remove_avl tag) {
+            return rank(child, tag);
+        }
+
+        template <typename Node, typename Tag, std::enable_if_t<is_one_of_v<Tag, capability_remove_redblack, capability_remove_interval>, int> = 0>
+        int child_rank(const Node& parent, int parent_rank, const std::unique_ptr<Node>&, Tag) {
+            return parent_rank - (parent.color_ == rb_black ? 1 : 0);
+        }
+
+        // Joins l < m < r into one tree. m is a detached node; its augment is recalculated.
+        template <typename Node>
+        ranked<Node> join(std::unique_ptr<Node> l, int, std::unique_ptr<Node> m, std::unique_ptr<Node> r, int, capability_remove) {
+            m->left_ = std::move(l);
+            m->right_ = std::move(r);
+            return { std::move(m), 0 };
+        }
+
+        template <typename Node, typename Tag>
+        void join_right(std::unique_ptr<Node>& t, std::unique_ptr<Node>& m, std::unique_ptr<Node>& r, int rr, Tag tag) { // descends the right spine of the higher tree
+            if (rank(t, tag) <= rr + 1) {
+                m->left_ = std::move(t);
+                m->right_ = std::move(r);
+                t = std::move(m);
+                update_height(t);
+                return;
+            }
+            join_right(t->right_, m, r, rr, tag);
+            fixup(t, tag);
+        }
+
+        template <typename Node, typename Tag>
+        void join_left(std::unique_ptr<Node>& t, std::unique_ptr<Node>& m, std::unique_ptr<Node>& l, int rl, Tag tag) { // mirrors join_right
+            if (rank(t, tag) <= rl + 1) {
+                m->right_ = std::move(t);
+                m->left_ = std::move(l);
+                t = std::move(m);
+                update_height(t);
+                return;
+            }
+            join_left(t->left_, m, l, rl, tag);
+            fixup(t, tag);
+        }
+
+        template <typename Node>
+        ranked<Node> join(std::unique_ptr<Node> l, int rl, std::unique_ptr<Node> m, std::unique_ptr<Node> r, int rr, capability_remove_avl tag) {
+            if (rl > rr + 1) {
+                join_right(l, m, r, rr, tag);
+                auto rank_l = rank(l, tag);
+                return { std::move(l), rank_l };
+            }
+            if (rr > rl + 1) {
+                join_left(r, m, l, rl, tag);
+                auto rank_r = rank(r, tag);
+                return { std::move(r), rank_r };
+            }
+            m->left_ = std::move(l);
+            m->right_ = std::move(r);
+            update_height(m);
+            auto rank_m = rank(m, tag);
+            return { std::move(m), rank_m };
+        }
+
+        // Tag is the insert tag of the tree: the red node m is hung in place of a black one of the same black height,
+        // so restoring the invariants is exactly what the insert fixup does on its way up.
+        template <typename Node, typename Tag>
+        void rbjoin_right(std::unique_ptr<Node>& t, int rt, std::unique_ptr<Node>& m, std::unique_ptr<Node>& r, int rr, Tag tag) {
+            if (rt == rr && (!t || t->color_ == rb_black)) {
+                m->color_ = rb_red;
+                m->left_ = std::move(t);
+                m->right_ = std::move(r);
+                t = std::move(m);
+                fixup(t, tag);
+                return;
+            }
+            rbjoin_right(t->right_, rt - (t->color_ == rb_black ? 1 : 0), m, r, rr, tag);
+            fixup(t, tag);
+        }
+
+        template <typename Node, typename Tag>
+        void rbjoin_left(std::unique_ptr<Node>& t, int rt, std::unique_ptr<Node>& m, std::unique_ptr<Node>& l, int rl, Tag tag) { // mirrors rbjoin_right
+            if (rt == rl && (!t || t->color_ == rb_black)) {
+                m->color_ = rb_red;
+                m->right_ = std::move(t);
+                m->left_ = std::move(l);
+                t = std::move(m);
+                fixup(t, tag);
+                return;
+            }
+            rbjoin_left(t->left_, rt - (t->color_ == rb_black ? 1 : 0), m, l, rl, tag);
+            fixup(t, tag);
+        }
+
+        template <typename Node, typename Tag>
+        ranked<Node> rbjoin(std::unique_ptr<Node> l, int rl, std::unique_ptr<Node> m, std::unique_ptr<Node> r, int rr, Tag tag) {
+            // a red root might be a subtree cut off from a bigger tree. repainting it black keeps it a valid rb-tree
+            if (l && l->color_ == rb_red) l->color_ = rb_black, ++rl;
+            if (r && r->color_ == rb_red) r->color_ = rb_black, ++rr;
+            auto result = ranked<Node>{};
+            if (rl > rr) {
+                rbjoin_right(l, rl, m, r, rr, tag);
+                result = { std::move(l), rl };
+            }
+            else if (rr > rl) {
+                rbjoin_left(r, rr, m, l, rl, tag);
+                result = { std::move(r), rr };
+            }
+            else {
+                m->color_ = rb_black;
+                m->left_ = std::move(l);
+                m->right_ = std::move(r);
+                fixup(m, tag);
+                return { std::move(m), rl + 1 };
+            }
+            if (result.tree_->color_ == rb_red) result.tree_->color_ = rb_black, ++result.rank_; // the fixup might have recolored the root
+            return result;
+        }
+
+        template <typename Node>
+        ranked<Node> join(std::unique_ptr<Node> l, int rl, std::unique_ptr<Node> m, std::unique_ptr<Node> r, int rr, capability_remove_redblack) {
+            return rbjoin(std::move(l), rl, std::move(m), std::move(r), rr, capability_insert_redblack{});
+        }
+
+        template <typename Node>
+        ranked<Node> join(std::unique_ptr<Node> l, int rl, std::unique_ptr<Node> m, std::unique_ptr<Node> r, int rr, capability_remove_interval) {
+            return rbjoin(std::move(l), rl, std::move(m), std::move(r), rr, capability_insert_interval{});
+        }
+
+        // Detaches the minimum of a non-empty tree keeping the rest of it valid
+        template <typename Node, typename Tag, std::enable_if_t<is_one_of_v<Tag, capability_remove, capability_remove_avl>, int> = 0>
+        std::unique_ptr<Node> take_min(std::unique_ptr<Node>& tree, Tag tag) {
+            return detach_min(tree, tag);
+        }
+
+        template <typename Node, typename Tag, std::enable_if_t<is_one_of_v<Tag, capability_remove_redblack, capability_remove_interval>, int> = 0>
+        std::unique_ptr<Node> take_min(std::unique_ptr<Node>& tree, Tag tag) {
+            std::unique_ptr<Node> min;
+            rbdetach_min(tree, min, tag); // a double black reaching the root just lowers the black height of the whole tree
+            if (tree) tree->color_ = rb_black;
+            return min;
+        }
+
+        // Joins l < r without a middle element
+        template <typename Node, typename Tag>
+        ranked<Node> join(ranked<Node> l, ranked<Node> r, Tag tag) {
+            if (!r.tree_) return l;
+            if (!l.tree_) return r;
+            auto m = take_min(r.tree_, tag);
+            auto rank_r = rank(r.tree_, tag); // the minimum might have taken a level with it
+            return join(std::move(l.tree_), l.rank_, std::move(m), std::move(r.tree_), rank_r, tag);
+        }
+
+        // Splits a tree of a given rank into elements less than v and the rest.
+        // Every join along the way costs the rank difference of its arguments, so the whole split is O(log n) for balanced trees.
+        template <typename Node, typename T, typename Tag>
+        std::pair<ranked<Node>, ranked<Node>> split(std::unique_ptr<Node> tree, int tree_rank, const T& v, Tag tag) {
+            if (!tree) return { ranked<Node>{ nullptr, tree_rank }, ranked<Node>{ nullptr, tree_rank } }; // an empty tree has a rank too: -1 for AVL
+            auto rl = child_rank(*tree, tree_rank, tree->left_, tag);
+            auto rr = child_rank(*tree, tree_rank, tree->right_, tag);
+            auto l = std::move(tree->left_);
+            auto r = std::move(tree->right_);
+            if (v > tree->value_) {
+                auto s = split(std::move(r), rr, v, tag);
+                return { join(std::move(l), rl, std::move(tree), std::move(s.first.tree_), s.first.rank_, tag), std::move(s.second) };
+            }
+            auto s = split(std::move(l), rl, v, tag);
+            return { std::move(s.first), join(std::move(s.second.tree_), s.second.rank_, std::move(tree), std::move(r), rr, tag) };
+        }
+
+        template <typename Node>
+        struct split_result {
+            ranked<Node>          less_;
+            std::unique_ptr<Node> equal_; // the node equal to the key, if any
+            ranked<Node>          greater_;
+        };
+
+        // Splits a tree into elements less than v, an element equal to v and elements greater than v.
+        // Unlike split, subtrees might come back with a red root; join takes care of them.
+        template <typename Node, typename T, typename Tag>
+        split_result<Node> split3(std::unique_ptr<Node> tree, int tree_rank, const T& v, Tag tag) {
+            if (!tree) return { ranked<Node>{ nullptr, tree_rank }, nullptr, ranked<Node>{ nullptr, tree_rank } };
+            auto rl = child_rank(*tree, tree_rank, tree->left_, tag);
+            auto rr = child_rank(*tree, tree_rank, tree->right_, tag);
+            auto l = std::move(tree->left_);
+            auto r = std::move(tree->right_);
+            if (v < tree->value_) {
+                auto s = split3(std::move(l), rl, v, tag);
+                s.greater_ = join(std::move(s.greater_.tree_), s.greater_.rank_, std::move(tree), std::move(r), rr, tag);
+                return s;
+            }
+            if (v > tree->value_) {
+                auto s = split3(std::move(r), rr, v, tag);
+                s.less_ = join(std::move(l), rl, std::move(tree), std::move(s.less_.tree_), s.less_.rank_, tag);
+                return s;
+            }
+            return { ranked<Node>{ std::move(l), rl }, std::move(tree), ranked<Node>{ std::move(r), rr } };
+        }
+
+        // A subtree cut off from a bigger tree might have a red root. Makes it a proper tree on its own.
+        template <typename Node>
+        void blacken_root(std::unique_ptr<Node>&, capability_remove) {}
+
+        template <typename Node>
+        void blacken_root(std::unique_ptr<Node>&, capability_remove_avl) {}
+
+        template <typename Node, typename Tag, std::enable_if_t<is_one_of_v<Tag, capability_remove_redblack, capability_remove_interval>, int> = 0>
+        void blacken_root(std::unique_ptr<Node>& tree, Tag) {
+            if (tree) tree->color_ = rb_black;
+        }
+
+        // Picks the removal tag of a tree. It defines how the tree is balanced when split or joined.
+        template <typename Tree>
+        using split_tag_t =
+            std::conditional_t<std::is_base_of_v<capability_remove_interval, Tree>, capability_remove_interval,
+            std::conditional_t<std::is_base_of_v<capability_remove_redblack, Tree>, capability_remove_redblack,
+            std::conditional_t<std::is_base_of_v<capability_remove_avl, Tree>, capability_remove_avl,
+            std::conditional_t<std::is_base_of_v<capability_remove, Tree>, capability_remove, void>>>>;
+
+        template <typename Tree, typename Tag = split_tag_t<Tree>>
+        constexpr bool is_splittable_v =
+            std::is_same_v<Tag, capability_remove>
+            || (std::is_same_v<Tag, capability_remove_avl>
+                && std::is_same_v<augment_type_t<Tree>, avl_augment<value_type_t<Tree>, node_type_t<Tree>>>
+                && !std::is_base_of_v<capability_rotate, Tree>) // rotation available on a user side may invalidate invariants
+            || (std::is_same_v<Tag, capability_remove_redblack>
+                && std::is_same_v<augment_type_t<Tree>, redblack_augment<value_type_t<Tree>, node_type_t<Tree>>>
+                && !std::is_base_of_v<capability_rotate, Tree>)
+            || (std::is_same_v<Tag, capability_remove_interval>
+                && std::is_base_of_v<interval_augment<value_type_t<Tree>, node_type_t<Tree>>, augment_type_t<Tree>>
+                && !std::is_base_of_v<capability_rotate, Tree>);
+
+        // Enables int type if a tree can be split/joined under its remove capability
+        template <typename Tree>
+        using enable_split_join_t = std::enable_if_t<is_splittable_v<Tree>, int>;
+    }
+
+    // Splits a tree into elements less than v and the rest in O(log n). Nodes are moved rather than copied, so the tree is left empty.
+    // An index of ends (capability_count_interval) adds O(k log n) for k intervals in the smaller part, and so does it for join.
+    template <typename T, typename Tree, aux::enable_split_join_t<Tree> = 0>
+    std::pair<Tree, Tree> split(Tree& tree, const T& v) {
+        auto tag = aux::split_tag_t<Tree>{};
+        auto&& root = aux::access(tree);
+        auto r = aux::rank(root, tag);
+        auto s = aux::split(std::move(root), r, v, tag);
+        std::pair<Tree, Tree> res;
+        aux::access(res.first) = std::move(s.first.tree_);
+        aux::access(res.second) = std::move(s.second.tree_);
+        if constexpr (aux::is_counted<Tree>::value) aux::split_ends(tree, res.first, res.second);
+        return res;
+    }
+
+    // Joins two trees in O(log n) provided all elements of l are less than those of r. Both trees are left empty.
+    template <typename Tree, aux::enable_split_join_t<Tree> = 0>
+    Tree join(Tree& l, Tree& r) {
+        using ranked = aux::ranked<aux::node_type_t<Tree>>;
+        auto tag = aux::split_tag_t<Tree>{};
+        auto rl = aux::rank(aux::access(l), tag);
+        auto rr = aux::rank(aux::access(r), tag);
+        Tree res;
+        aux::access(res) = aux::join(ranked{ std::move(aux::access(l)), rl }, ranked{ std::move(aux::access(r)), rr }, tag).tree_;
+        if constexpr (aux::is_counted<Tree>::value) aux::join_ends(res, l, r);
+        return res;
+    }
+
+    // Removes all elements within [lo, hi) in O(log n + k): the range is cut off by two splits as a whole
+    // and the outer parts are joined back, so the tree is rebalanced once rather than k times. An index of ends adds O(k log n).
+    template <typename T, typename Tree, aux::enable_split_join_t<Tree> = 0>
+    void erase_range(Tree& tree, const T& lo, const T& hi) {
+        if (!(lo < hi)) return;
+        auto tag = aux::split_tag_t<Tree>{};
+        auto&& root = aux::access(tree);
+        auto r = aux::rank(root, tag);
+        auto less = aux::split(std::move(root), r, lo, tag);
+        auto rest = aux::split(std::move(less.second.tree_), less.second.rank_, hi, tag);
+        root = aux::join(std::move(less.first), std::move(rest.second), tag).tree_;
+        if constexpr (aux::is_counted<Tree>::value) aux::remove_ends(tree.ends_, rest.first.tree_);
+        // rest.first holds the erased range and is released here
+    }
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "tree_set_operations.hpp"
+#include "tree_avl.hpp"
+#include "tree_redblack.hpp"
+#include "tree_interval.hpp"
+#include "type_cti.hpp"
+
+#include <algorithm> // std::max
+#include <cstddef> // size_t
+#include <cstdlib> // std::abs
+#include <memory> // std::unique_ptr
+#include <type_traits>
+
+namespace tree_search {
+
+    // What validate has found. Every violation is counted at the node it shows at; checks a tree does not need stay at zero.
+    struct validation_report {
+        size_t size_ = 0;
+        int    height_ = 0;                    // nodes on the longest path
+        int    black_height_ = 0;              // red-black trees only: black nodes on a path, sentinels excluded
+        size_t order_violations_ = 0;          // nodes not greater than the greatest of their left subtree or not less than the least of their right one
+        size_t color_violations_ = 0;          // red nodes with a red child, and a red root
+        size_t black_height_violations_ = 0;   // nodes whose subtrees differ in black height
+        size_t height_violations_ = 0;         // AVL trees: nodes with a wrong height_ or with subtrees differing in height by more than one
+        size_t aggregate_violations_ = 0;      // interval trees: nodes with a wrong max_
+        size_t count_violations_ = 0;          // interval trees: nodes whose count_ is not the size of their subtree
+
+        bool valid() const {
+            return this->order_violations_ == 0 && this->color_violations_ == 0 && this->black_height_violations_ == 0
+                && this->height_violations_ == 0 && this->aggregate_violations_ == 0 && this->count_violations_ == 0;
+        }
+    };
+
+    namespace aux {
+
+        template <typename Node>
+        constexpr bool is_redblack_node_v = std::is_base_of_v<redblack_augment<value_type_t<Node>, Node>, augment_type_t<Node>>;
+
+        template <typename Node>
+        constexpr bool is_avl_node_v = std::is_base_of_v<avl_augment<value_type_t<Node>, Node>, augment_type_t<Node>>;
+
+        // Report of a subtree along with its least and greatest elements, which the order of its parent is checked against
+        template <typename Node>
+        struct validated {
+            validation_report report_;
+            const Node*       min_ = nullptr;
+            const Node*       max_ = nullptr;
+        };
+
+        template <typename Node, std::enable_if_t<is_redblack_node_v<Node>, int> = 0>
+        void validate_balance(const Node& node, const validation_report& l, const validation_report& r, validation_report& res) {
+            auto red = [](const std::unique_ptr<Node>& t) { return t && t->color_ == rb_red; };
+            if (node.color_ == rb_red && (red(node.left_) || red(node.right_))) ++res.color_violations_;
+            if (l.black_height_ != r.black_height_) ++res.black_height_violations_;
+            res.black_height_ = std::max(l.black_height_, r.black_height_) + (node.color_ == rb_black ? 1 : 0);
+        }
+
+        template <typename Node, std::enable_if_t<is_avl_node_v<Node>, int> = 0>
+        void validate_balance(const Node& node, const validation_report& l, const validation_report& r, validation_report& res) {
+            if (node.height_ != res.height_ - 1 || std::abs(l.height_ - r.height_) > 1) ++res.height_violations_; // height_ of a leaf is 0
+        }
+
+        template <typename Node, std::enable_if_t<!is_redblack_node_v<Node> && !is_avl_node_v<Node>, int> = 0>
+        void validate_balance(const Node&, const validation_report&, const validation_report&, validation_report&) {}
+
+        template <typename Node, std::enable_if_t<is_redblack_node_v<Node>, int> = 0>
+        void validate_root(const Node& root, validation_report& res) {
+            if (root.color_ == rb_red) ++res.color_violations_;
+        }
+
+        template <typename Node, std::enable_if_t<!is_redblack_node_v<Node>, int> = 0>
+        void validate_root(const Node&, validation_report&) {}
+
+        // Children are checked on their own, so the stored aggregates of children are taken as they are
+        template <typename Node, std::enable_if_t<has_interval_aggregates<Node>::value, int> = 0>
+        void validate_aggregates(const Node& node, validation_report& res) {
+            auto max = end_of(node.value_);
+            size_t count = 1;
+            for (auto child : { node.left_.get(), node.right_.get() })
+                if (child) {
+                    max = std::max(max, child->max_);
+                    count += child->count_;
+                }
+            if (!(node.max_ == max)) ++res.aggregate_violations_;
+            if (node.count_ != count) ++res.count_violations_;
+        }
+
+        template <typename Node, std::enable_if_t<!has_interval_aggregates<Node>::value, int> = 0>
+        void validate_aggregates(const Node&, validation_report&) {}
+
+        // Subtrees are checked independently, the top levels of them in tasks of their own
+        template <typename Node>
+        validated<Node> validate(const std::unique_ptr<Node>& tree, int forks) {
+            if (!tree) return {};
+            auto lr = fork_join(forks > 0,
+                [&] { return validate(tree->left_, forks - 1); },
+                [&] { return validate(tree->right_, forks - 1); });
+            auto&& l = lr.first;
+            auto&& r = lr.second;
+            validated<Node> res;
+            auto&& rep = res.report_;
+            for (auto&& part : { &l.report_, &r.report_ }) {
+                rep.order_violations_ += part->order_violations_;
+                rep.color_violations_ += part->color_violations_;
+                rep.black_height_violations_ += part->black_height_violations_;
+                rep.height_violations_ += part->height_violations_;
+                rep.aggregate_violations_ += part->aggregate_violations_;
+                rep.count_violations_ += part->count_violations_;
+            }
+            rep.size_ = l.report_.size_ + r.report_.size_ + 1;
+            rep.height_ = std::max(l.report_.height_, r.report_.height_) + 1;
+            if (l.max_ && !(l.max_->value_ < tree->value_)) ++rep.order_violations_;
+            if (r.min_ && !(tree->value_ < r.min_->value_)) ++rep.order_violations_;
+            res.min_ = l.min_ ? l.min_ : tree.get();
+            res.max_ = r.max_ ? r.max_ : tree.get();
+            validate_balance(*tree, l.report_, r.report_, rep);
+            validate_aggregates(*tree, rep);
+            return res;
+        }
+
+        template <typename Tree>
+        using enable_validate_t = std::enable_if_t<std::is_same_v<std::decay_t<decltype(access(std::declval<const Tree&>()))>, std::unique_ptr<node_type_t<Tree>>>, int>;
+    }
+
+    // Checks order, balance and aggregates of a tree in one pass: what optimal, balanced and perfect tell
+    // for a tree as a whole is counted per node. Subtrees are checked in parallel unless the tree is small;
+    // the length of its leftmost path tells, for balanced trees at least.
+    //     auto report = tree_search::validate(bin);
+    //     assert(report.valid() && report.size_ == expected);
+    template <typename Tree, aux::enable_validate_t<Tree> = 0>
+    validation_report validate(const Tree& tree) {
+        auto&& root = aux::access(tree);
+        int spine = 0;
+        for (auto p = root.get(); p; p = p->left_.get()) ++spine;
+        auto forks = spine < 12 ? 0 : aux::fork_depth();
+        auto res = aux::validate(root, forks).report_;
+        if (root) aux::validate_root(*root, res);
+        return res;
+    }
+}
\ No newline at end of file
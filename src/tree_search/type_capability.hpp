@@ -1,5 +1,8 @@
 #pragma once
 
+#include <type_traits>
+#include <utility> // std::declval
+
 namespace tree_search {
 
     struct capability_insert {};
@@ -14,6 +17,9 @@ namespace tree_search {
     struct capability_search_interval {};
     struct capability_remove_interval {};
 
+    struct capability_insert_interval_avl {};
+    struct capability_remove_interval_avl {};
+
     struct capability_insert_redblack {};
     struct capability_remove_redblack {};
 
@@ -23,4 +29,20 @@ namespace tree_search {
     struct capability_supress_warning_redblack {};
     struct capability_supress_warning_interval {};
     struct capability_supress_warning_avl {};
+
+    struct capability_shared; // carries a lock, see capability_shared.hpp
+
+    template <typename T>
+    struct capability_count_interval; // carries an index of interval ends, see tree_interval.hpp
+
+    namespace aux {
+
+        template <typename T>
+        std::true_type counts_ends(const capability_count_interval<T>*);
+        std::false_type counts_ends(const void*);
+
+        // Tells if a tree keeps an index of ends (capability_count_interval)
+        template <typename Tree>
+        using is_counted = decltype(counts_ends(std::declval<std::decay_t<Tree>*>()));
+    }
 }